@@ -1,5 +1,16 @@
 // Time the different CCD methods
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 #include <CLI/CLI.hpp>
@@ -9,18 +20,59 @@
 #include <ghc/fs_std.hpp> // filesystem
 
 #include <ccd.hpp>
+#include <query_preprocessing.hpp>
+#if CCD_WRAPPER_WITH_RP_FILTER
+#include <root_parity/filtered_root_parity.hpp>
+#endif
+#if CCD_WRAPPER_WITH_FXRP
+#include <root_parity/fixed_point_root_parity.hpp>
+#endif
+#include <utils/allocation_counter.hpp>
+#include <utils/benchmark_report.hpp>
+#include <utils/binary_queries.hpp>
+#include <utils/cache_eviction.hpp>
+#include <utils/cpu_affinity.hpp>
+#include <utils/get_rss.hpp>
+#include <utils/latency_histogram.hpp>
+#include <utils/parameter_sweep.hpp>
+#include <utils/perf_counters.hpp>
+#include <utils/query_sampling.hpp>
+#include <utils/query_stream.hpp>
 #include <utils/read_rational_csv.hpp>
+#include <utils/scaling_study.hpp>
+#include <utils/slowest_queries.hpp>
 #include <utils/timer.hpp>
 
 using namespace ccd;
 
+/// Scenes of the simulation dataset; every other scene is handcrafted.
 std::vector<std::string> simulation_folders
     = { { "chain", "cow-heads", "golf-ball", "mat-twist" } };
-std::vector<std::string> handcrafted_folders
-    = { { "erleben-sliding-spike", "erleben-spike-wedge",
-          "erleben-sliding-wedge", "erleben-wedge-crack", "erleben-spike-crack",
-          "erleben-wedges", "erleben-cube-cliff-edges", "erleben-spike-hole",
-          "erleben-cube-internal-edges", "erleben-spikes", "unit-tests" } };
+
+/// Time of an empty timed region (ns), subtracted from every query
+double timer_overhead = 0;
+
+/// Median time of an empty timed region over many runs.
+double measure_timer_overhead()
+{
+    Timer timer;
+    std::vector<double> times(10001);
+    for (double& time : times) {
+        timer.start();
+        timer.stop();
+        time = timer.getElapsedTimeInNanoSec();
+    }
+    std::nth_element(
+        times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+/// Where the queries are in the caches when they are timed (--cache)
+enum CacheMode {
+    WARM_CACHE,      ///< Run back to back in file order
+    COLD_CACHE,      ///< Evict the caches before every query
+    SHUFFLED_QUERIES ///< Run in random order over a large working set
+};
 
 struct CLIArgs {
     fs::path data_dir = CCD_WRAPPER_SAMPLE_QUERIES_DIR;
@@ -28,10 +80,38 @@ struct CLIArgs {
     double minimum_separation = 0;
     double tight_inclusion_tolerance = 1e-6;
     long tight_inclusion_max_iter = 1e6;
+    int quantization_bits = -1;
+    QueryPreprocessing preprocessing = NO_PREPROCESSING;
     bool run_ee_dataset = true;
     bool run_vf_dataset = true;
     bool run_simulation_dataset = true;
     bool run_handcrafted_dataset = true;
+    int num_threads = 1;
+    bool prefetch = true;
+    bool single_pass = false;
+    bool perf_counters = false;
+    bool count_allocations = false;
+    CacheMode cache_mode = WARM_CACHE;
+    int working_set_mib = 256; ///< with --cache shuffled
+    std::vector<std::string> scene_patterns, file_patterns;
+    uint64_t sample_size = 0; ///< queries per dataset (0 for all)
+    unsigned seed = 0;
+    int shard_index = 0, num_shards = 1; ///< --shard i/n
+    std::vector<std::string> merge_paths;
+    size_t num_slowest = 0; ///< --dump-slowest
+    std::string dump_dir = ".";
+    std::string replay_path;
+    int num_replays = 100;
+    /// Whether any option of query_options was given
+    bool has_query_options = false;
+    std::vector<int> scaling_threads; ///< thread counts of --scaling
+    /// Values of the parameter sweep (--sweep-*)
+    std::vector<double> sweep_tolerances, sweep_minimum_separations;
+    std::vector<long> sweep_max_iters;
+    bool numa_aware = false;
+    std::vector<std::string> output_paths;
+    std::string baseline_path;
+    double regression_threshold = 0.05; ///< fraction of the baseline time
 
     CLIArgs(int argc, char* argv[])
     {
@@ -92,6 +172,179 @@ struct CLIArgs {
                "Tight Inclusion maximum iterations (mᵢ)")
             ->default_val(tight_inclusion_max_iter);
 
+        app.add_option(
+               "--quantize", quantization_bits,
+               "round query coordinates to multiples of 2⁻ᵇ before running "
+               "(e.g., for fixed-point methods)")
+            ->check(CLI::NonNegativeNumber);
+
+        const std::vector<std::pair<std::string, QueryPreprocessing>>
+            name_to_preprocessing = {
+                { "none", NO_PREPROCESSING },
+                { "translate", TRANSLATE },
+                { "rescale", TRANSLATE_AND_RESCALE },
+            };
+        app.add_option(
+               "--preprocess", preprocessing,
+               "normalize each query before dispatch\n"
+               "options: none, translate, rescale (translate and rescale)")
+            ->transform(CLI::CheckedTransformer(
+                name_to_preprocessing, CLI::ignore_case))
+            ->default_val(preprocessing);
+
+        app.add_option(
+               "-j,--threads", num_threads,
+               "number of threads running query files in parallel (use at "
+               "most one per physical core to keep the timings accurate)")
+            ->check(CLI::PositiveNumber)
+            ->default_val(num_threads);
+
+        app.add_option(
+               "--scaling", scaling_threads,
+               "instead of the benchmark, time every method with each of these "
+               "numbers of threads pinned to cores (e.g., 1,2,4,8)")
+            ->delimiter(',')
+            ->check(CLI::PositiveNumber);
+
+        app.add_option(
+               "--sweep-ti-tolerance", sweep_tolerances,
+               "instead of the benchmark, time the minimum separation methods "
+               "with each of these Tight Inclusion tolerances (and the other "
+               "--sweep-* values) and print the Pareto frontier of time and "
+               "false positives")
+            ->delimiter(',')
+            ->check(CLI::PositiveNumber);
+
+        app.add_option(
+               "--sweep-ti-max-iter", sweep_max_iters,
+               "Tight Inclusion maximum iterations of the sweep")
+            ->delimiter(',');
+
+        app.add_option(
+               "--sweep-minimum-separation", sweep_minimum_separations,
+               "minimum separation distances of the sweep")
+            ->delimiter(',')
+            ->check(CLI::NonNegativeNumber);
+
+        app.add_flag(
+            "--numa", numa_aware,
+            "with --scaling, spread the threads evenly over the NUMA nodes");
+
+        app.add_flag(
+            "--single-pass", single_pass,
+            "load each query once and run every method on it, reporting "
+            "where the methods disagree");
+
+        const std::vector<std::pair<std::string, CacheMode>>
+            name_to_cache_mode = {
+                { "warm", WARM_CACHE },
+                { "cold", COLD_CACHE },
+                { "shuffled", SHUFFLED_QUERIES },
+            };
+        app.add_option(
+               "--cache", cache_mode,
+               "state of the caches when a query is timed\n"
+               "options: warm (back to back), cold (evict the caches before "
+               "each query), shuffled (random order over --working-set); cold "
+               "and shuffled also time each query again warm")
+            ->transform(
+                CLI::CheckedTransformer(name_to_cache_mode, CLI::ignore_case))
+            ->default_val(cache_mode);
+
+        app.add_option(
+               "--working-set", working_set_mib,
+               "MiB of queries shuffled together with --cache shuffled (make "
+               "it larger than the last-level cache)")
+            ->check(CLI::PositiveNumber)
+            ->default_val(working_set_mib);
+
+        app.add_flag(
+            "--perf-counters", perf_counters,
+            "count cycles, instructions, branch misses, and cache misses per "
+            "query with the hardware performance counters (Linux)");
+
+        app.add_flag(
+            "--allocations", count_allocations,
+            "count the heap allocations (operator new and GMP) and their "
+            "bytes per query, and the most bytes a query has allocated at "
+            "once");
+
+        app.add_flag(
+            "!--no-prefetch", prefetch,
+            "do not read queries ahead on a spare core while running them");
+
+        app.add_option(
+            "-o,--output", output_paths,
+            "write the results to a .json or .csv file (repeatable)");
+
+        app.add_option(
+               "--compare", baseline_path,
+               "compare with a JSON report of an earlier run and exit with "
+               "status 1 if a method got slower or has more false negatives")
+            ->check(CLI::ExistingFile);
+
+        std::string threshold_str = "5%";
+        app.add_option(
+               "--threshold", threshold_str,
+               "slowdown of the average time that --compare reports as a "
+               "regression (e.g., 5% or 0.05)")
+            ->default_val(threshold_str);
+
+        std::string shard_str;
+        app.add_option(
+            "--shard", shard_str,
+            "run only shard i of n (e.g., 2/8): every n-th query file of "
+            "each dataset, to split a run across processes");
+
+        app.add_option(
+            "--merge", merge_paths,
+            "instead of running, merge the JSON reports of the shards of a "
+            "run into --output (and --compare it)")
+            ->check(CLI::ExistingFile);
+
+        app.add_option(
+               "--dump-slowest", num_slowest,
+               "write the K slowest queries of each method and dataset to "
+               "slowest-<method>-<dataset>-<type>.csv in --dump-dir, with "
+               "their source file, index, time, and counters")
+            ->check(CLI::PositiveNumber);
+
+        app.add_option(
+               "--dump-dir", dump_dir, "directory of the --dump-slowest files")
+            ->default_val(dump_dir);
+
+        app.add_option(
+               "--replay", replay_path,
+               "instead of the benchmark, run the queries of a --dump-slowest "
+               "file --replay-repetitions times (e.g., under a profiler)")
+            ->check(CLI::ExistingFile);
+
+        app.add_option(
+               "--replay-repetitions", num_replays,
+               "times each query runs with --replay")
+            ->check(CLI::PositiveNumber)
+            ->default_val(num_replays);
+
+        app.add_option(
+            "--scene", scene_patterns,
+            "only run scenes whose name matches one of these patterns "
+            "(* and ?, e.g., erleben-*)");
+
+        app.add_option(
+            "--file", file_patterns,
+            "only run query files whose path relative to the data directory "
+            "matches one of these patterns (e.g., */edge-edge/*001.csv)");
+
+        app.add_option(
+               "--sample", sample_size,
+               "run a random sample of this many queries per dataset, "
+               "stratified by scene and ground truth, and estimate the "
+               "latency of all queries with confidence intervals")
+            ->check(CLI::PositiveNumber);
+
+        app.add_option("--seed", seed, "random seed of --sample")
+            ->default_val(seed);
+
         app.add_flag(
             "!--no-ee", run_ee_dataset, "do not run the edge-edge dataset");
         app.add_flag(
@@ -109,182 +362,1974 @@ struct CLIArgs {
         } catch (const CLI::ParseError& e) {
             exit(app.exit(e));
         }
+        has_query_options = app.count("-d") + app.count("--delta")
+                + app.count("--mi") + app.count("--preprocess")
+            > 0;
 
         if (!data_dir_str.empty()) {
             data_dir = data_dir_str;
         }
+
+        for (const std::string& path : output_paths) {
+            const std::string extension = fs::path(path).extension().string();
+            if (extension != ".json" && extension != ".csv") {
+                std::cerr << "--output: unknown format of " << path
+                          << " (expected .json or .csv)" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        std::sort(scaling_threads.begin(), scaling_threads.end());
+        scaling_threads.erase(
+            std::unique(scaling_threads.begin(), scaling_threads.end()),
+            scaling_threads.end());
+
+        if (!shard_str.empty()) {
+            char slash;
+            std::istringstream shard_stream(shard_str);
+            if (!(shard_stream >> shard_index >> slash >> num_shards)
+                || !shard_stream.eof() || slash != '/' || num_shards < 1
+                || shard_index < 1 || shard_index > num_shards) {
+                std::cerr << "--shard: expected i/n with 1 ≤ i ≤ n, got "
+                          << shard_str << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            shard_index--;
+        }
+        if (is_sweep() && (!scaling_threads.empty() || num_shards > 1)) {
+            std::cerr << "--sweep-* cannot be combined with --scaling or "
+                         "--shard"
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (num_shards > 1 && !scaling_threads.empty()) {
+            std::cerr << "--shard cannot be combined with --scaling"
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        char* threshold_end;
+        regression_threshold
+            = std::strtod(threshold_str.c_str(), &threshold_end);
+        if (*threshold_end == '%') {
+            regression_threshold /= 100;
+            threshold_end++;
+        }
+        if (threshold_str.empty() || *threshold_end != '\0'
+            || !(regression_threshold >= 0)) {
+            std::cerr << "--threshold: invalid value " << threshold_str
+                      << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bool is_sweep() const
+    {
+        return !sweep_tolerances.empty() || !sweep_max_iters.empty()
+            || !sweep_minimum_separations.empty();
+    }
+};
+
+/// Round every coordinate to the nearest multiple of 2⁻ᵇ.
+Eigen::Matrix<double, 8, 3>
+quantize(const Eigen::Matrix<double, 8, 3>& V, const int bits)
+{
+    const double scale = std::ldexp(1.0, bits);
+    return ((V * scale).array().round() / scale).matrix();
+}
+
+/// Total size of the coordinates of a query as exact reduced fractions.
+struct RationalSize {
+    long bits = 0;  ///< bits of the numerators and denominators
+    long limbs = 0; ///< 64-bit limbs of the numerators and denominators
+
+    void add(const Eigen::Matrix<double, 8, 3>& V)
+    {
+        for (int i = 0; i < V.size(); i++) {
+            // x = m·2ᵉ with an odd integer m
+            int e = 0;
+            double m = V(i) == 0 ? 0 : std::ldexp(std::frexp(V(i), &e), 53);
+            e -= 53;
+            while (m != 0 && std::fmod(m, 2) == 0) {
+                m /= 2;
+                e++;
+            }
+            const int numerator_bits =
+                m == 0 ? 0 : std::ilogb(m) + 1 + std::max(e, 0);
+            const int denominator_bits = std::max(-e, 0) + 1;
+            bits += numerator_bits + denominator_bits;
+            limbs += (numerator_bits + 63) / 64 + (denominator_bits + 63) / 64;
+        }
+    }
+};
+
+/// Counters of one method over a set of queries.
+struct BenchmarkResults {
+    long num_queries = 0;
+    long num_positives = 0;
+    long num_false_positives = 0;
+    long num_false_negatives = 0;
+    /// Queries the method cannot take (e.g., beyond the fixed-point bit
+    /// budget), skipped and not in the counts above
+    long num_skipped = 0;
+    double total_time = 0; ///< μs
+    LatencyHistogram latency; ///< ns per query
+    /// ns per query run again right after (with --cache cold or shuffled)
+    LatencyHistogram warm_latency;
+    /// Per ground truth (negative, positive) for --sample estimates
+    LatencyHistogram class_latency[2];
+    double class_time[2] = {}, class_time_squared[2] = {}; ///< ns, ns²
+    RationalSize original_size, preprocessed_size;
+    uint64_t num_filtered = 0;  ///< queries seen by the root parity filter
+    uint64_t num_certified = 0; ///< queries the filter decided
+    PerfCounts counters;        ///< per query with --perf-counters
+    /// With --allocations
+    uint64_t num_allocations = 0, allocated_bytes = 0;
+    long num_allocating_queries = 0; ///< with at least one allocation
+    int64_t peak_live_bytes = 0;     ///< largest of a query
+    /// With --dump-slowest, a heap of the slowest queries (at most that many
+    /// per task; merged results keep all of theirs)
+    std::vector<SlowQuery> slowest;
+    /// With --sweep-*, the time of impact of every query in the order run
+    /// (NaN where the method does not compute one)
+    std::vector<double> tois;
+
+    /// Whether a query of this time is among the k slowest so far.
+    bool is_slowest(const double time, const size_t k) const
+    {
+        return slowest.size() < k
+            || (k > 0 && time > slowest.front().time);
+    }
+
+    /// Keep a query among the k slowest (see is_slowest).
+    void keep_slowest(const SlowQuery& query, const size_t k)
+    {
+        slowest.push_back(query);
+        std::push_heap(slowest.begin(), slowest.end(), SlowQuery::is_slower);
+        if (slowest.size() > k) {
+            std::pop_heap(
+                slowest.begin(), slowest.end(), SlowQuery::is_slower);
+            slowest.pop_back();
+        }
+    }
+
+    void merge(const BenchmarkResults& other)
+    {
+        num_queries += other.num_queries;
+        num_positives += other.num_positives;
+        num_false_positives += other.num_false_positives;
+        num_false_negatives += other.num_false_negatives;
+        num_skipped += other.num_skipped;
+        total_time += other.total_time;
+        latency.merge(other.latency);
+        warm_latency.merge(other.warm_latency);
+        for (int c = 0; c < 2; c++) {
+            class_latency[c].merge(other.class_latency[c]);
+            class_time[c] += other.class_time[c];
+            class_time_squared[c] += other.class_time_squared[c];
+        }
+        original_size.bits += other.original_size.bits;
+        original_size.limbs += other.original_size.limbs;
+        preprocessed_size.bits += other.preprocessed_size.bits;
+        preprocessed_size.limbs += other.preprocessed_size.limbs;
+        num_filtered += other.num_filtered;
+        num_certified += other.num_certified;
+        counters.merge(other.counters);
+        num_allocations += other.num_allocations;
+        allocated_bytes += other.allocated_bytes;
+        num_allocating_queries += other.num_allocating_queries;
+        peak_live_bytes = std::max(peak_live_bytes, other.peak_live_bytes);
+        if (!other.slowest.empty()) {
+            slowest.insert(
+                slowest.end(), other.slowest.begin(), other.slowest.end());
+            std::make_heap(
+                slowest.begin(), slowest.end(), SlowQuery::is_slower);
+        }
+        tois.insert(tois.end(), other.tois.begin(), other.tois.end());
+    }
+};
+
+/// How often methods run on the same queries give different results.
+struct AgreementMatrix {
+    size_t num_methods = 0;
+    /// Queries where methods i and j differ at [i * num_methods + j]
+    std::vector<long> num_disagreements;
+    /// First such query ("file:index") for each pair
+    std::vector<std::string> first_disagreements;
+
+    explicit AgreementMatrix(size_t num_methods = 0)
+        : num_methods(num_methods)
+        , num_disagreements(num_methods * num_methods, 0)
+        , first_disagreements(num_methods * num_methods)
+    {
+    }
+
+    /// @param is_run  Which methods ran the query (the others are ignored).
+    void add(
+        const std::vector<bool>& results,
+        const std::vector<bool>& is_run,
+        const fs::path& path,
+        size_t i)
+    {
+        for (size_t a = 0; a < num_methods; a++) {
+            for (size_t b = a + 1; b < num_methods; b++) {
+                if (is_run[a] && is_run[b] && results[a] != results[b]) {
+                    record(a, b, path, i);
+                }
+            }
+        }
+    }
+
+    void merge(const AgreementMatrix& other)
+    {
+        for (size_t k = 0; k < num_disagreements.size(); k++) {
+            num_disagreements[k] += other.num_disagreements[k];
+            if (first_disagreements[k].empty()) {
+                first_disagreements[k] = other.first_disagreements[k];
+            }
+        }
+    }
+
+private:
+    void record(size_t a, size_t b, const fs::path& path, size_t i)
+    {
+        for (size_t k : { a * num_methods + b, b * num_methods + a }) {
+            num_disagreements[k]++;
+            if (first_disagreements[k].empty()) {
+                first_disagreements[k] = fmt::format("{}:{}", path.string(), i);
+            }
+        }
+    }
+};
+
+/// Results of a task or group: one per method, and how they agree.
+struct MethodsResults {
+    std::vector<BenchmarkResults> methods;
+    AgreementMatrix agreement;
+    /// The first query where Tight Inclusion missed a collision, which stops
+    /// the benchmark once no thread is running queries
+    std::string tight_inclusion_false_negative;
+
+    explicit MethodsResults(size_t num_methods = 0)
+        : methods(num_methods)
+        , agreement(num_methods)
+    {
+    }
+
+    void merge(const MethodsResults& other)
+    {
+        for (size_t k = 0; k < methods.size(); k++) {
+            methods[k].merge(other.methods[k]);
+        }
+        agreement.merge(other.agreement);
+        if (tight_inclusion_false_negative.empty()) {
+            tight_inclusion_false_negative
+                = other.tight_inclusion_false_negative;
+        }
+    }
+};
+
+/// The queries of one query file to run with one or more methods.
+struct BenchmarkTask {
+    std::vector<CCDMethod> methods;
+    bool is_edge_edge;
+    fs::path path;
+    /// With --sample, the number of negative and positive queries in the
+    /// file (or range), and how many of each to run
+    uint64_t num_queries[2];
+    uint64_t sample_size[2];
+    /// A range of max_queries queries from start, or all if it is zero
+    QueryStreamPosition start;
+    uint64_t max_queries;
+};
+
+/// Methods on one dataset (e.g., the simulation edge-edge queries).
+struct BenchmarkGroup {
+    std::vector<CCDMethod> methods;
+    bool is_edge_edge;
+    bool is_simulation_data;
+    size_t first_task, end_task; ///< range in the list of tasks
+};
+
+/// Hardware counters of a thread and their counts of an empty timed region,
+/// subtracted from every query like the timer overhead.
+struct QueryCounters {
+    PerfCounters counters;
+    uint64_t overhead[NUM_PERF_EVENTS];
+
+    QueryCounters()
+    {
+        // Per event median over many runs
+        std::vector<uint64_t> counts[NUM_PERF_EVENTS];
+        Timer timer;
+        for (int i = 0; i < 1001; i++) {
+            uint64_t before[NUM_PERF_EVENTS], after[NUM_PERF_EVENTS];
+            counters.read(before);
+            timer.start();
+            timer.stop();
+            counters.read(after);
+            for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+                counts[e].push_back(after[e] - before[e]);
+            }
+        }
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            std::nth_element(
+                counts[e].begin(), counts[e].begin() + counts[e].size() / 2,
+                counts[e].end());
+            overhead[e] = counts[e][counts[e].size() / 2];
+        }
     }
 };
 
-void run_rational_data_single_method(
+/// Time a method on a query, including its preprocessing.
+/// @param query      Read in place unless it is preprocessed, so where it is
+///                   in memory (see --cache) is part of the time.
+/// @param[out] V     The preprocessed query (if args.preprocessing is set).
+/// @param[out] time  ns
+/// @param[out] toi   If not null, the time of impact (see vertexFaceCCD).
+bool time_ccd_query(
     const CLIArgs& args,
     const CCDMethod method,
     const bool is_edge_edge,
-    const bool is_simulation_data)
+    const Eigen::Matrix<double, 8, 3>& query,
+    Eigen::Matrix<double, 8, 3>& V,
+    double& time,
+    double* const toi = nullptr)
 {
     bool use_msccd = is_minimum_separation_method(method);
-    Eigen::MatrixXd all_V;
-    std::vector<bool> results;
     Timer timer;
 
-    int total_number = -1;
-    double total_time = 0.0;
-    int total_positives = 0;
-    int num_false_positives = 0;
-    int num_false_negatives = 0;
+    if (args.preprocessing != NO_PREPROCESSING) {
+        V = query;
+    }
+    const Eigen::Matrix<double, 8, 3>& Q
+        = args.preprocessing != NO_PREPROCESSING ? V : query;
 
-    std::string sub_folder = is_edge_edge ? "edge-edge" : "vertex-face";
+    bool result;
+    timer.start();
+    // Distances scale with a rescaled query.
+    const double scale = preprocess_query(V, args.preprocessing, method);
+    if (use_msccd) {
+        if (is_edge_edge) {
+            result = edgeEdgeMSCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), scale * args.minimum_separation, method,
+                scale * args.tight_inclusion_tolerance,
+                args.tight_inclusion_max_iter, { { -1, 0, 0 } }, toi);
+        } else {
+            result = vertexFaceMSCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), scale * args.minimum_separation, method,
+                scale * args.tight_inclusion_tolerance,
+                args.tight_inclusion_max_iter, { { -1, 0, 0 } }, toi);
+        }
+    } else {
+        if (is_edge_edge) {
+            result = edgeEdgeCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), method,
+                scale * args.tight_inclusion_tolerance,
+                args.tight_inclusion_max_iter, { { -1, 0, 0 } }, toi);
+        } else {
+            result = vertexFaceCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), method,
+                scale * args.tight_inclusion_tolerance,
+                args.tight_inclusion_max_iter, { { -1, 0, 0 } }, toi);
+        }
+    }
+    timer.stop();
+    time = std::max(timer.getElapsedTimeInNanoSec() - timer_overhead, 0.0);
+    return result;
+}
+
+/// Whether a method can run a query as it will be passed to it: the
+/// fixed-point method only takes queries within its bit budget, and would
+/// otherwise fail and answer conservatively.
+bool is_query_supported(
+    const CLIArgs& args,
+    const CCDMethod method,
+    const Eigen::Matrix<double, 8, 3>& query)
+{
+#if CCD_WRAPPER_WITH_FXRP
+    if (method == CCDMethod::FIXED_POINT_ROOT_PARITY) {
+        Eigen::Matrix<double, 8, 3> V = query;
+        preprocess_query(V, args.preprocessing, method);
+        return root_parity::fits_fixed_point_budget(V);
+    }
+#else
+    (void)args, (void)method, (void)query;
+#endif
+    return true;
+}
 
-    const std::vector<std::string>& scene_names
-        = is_simulation_data ? simulation_folders : handcrafted_folders;
+/// Run and time one query with one method, and count its result.
+/// @return The result of the method.
+/// @param path, index  Where the query is from (for --dump-slowest).
+/// @param counters     Hardware counters of this thread, or nullptr.
+/// @param evictor      With --cache cold, evicts the caches before the query.
+bool run_query(
+    const CLIArgs& args,
+    const CCDMethod method,
+    const bool is_edge_edge,
+    const Eigen::Matrix<double, 8, 3>& query,
+    const bool expected_result,
+    const fs::path& path,
+    const size_t index,
+    BenchmarkResults& stats,
+    const QueryCounters* counters,
+    CacheEvictor* evictor)
+{
+    if (args.preprocessing != NO_PREPROCESSING) {
+        stats.original_size.add(query);
+    }
+#if CCD_WRAPPER_WITH_RP_FILTER
+    // The counters are per thread and shared by the methods of a task.
+    const root_parity::FilterStatistics filter_stats_before
+        = root_parity::filter_statistics();
+#endif
+    if (evictor != nullptr) {
+        evictor->evict(query.data(), sizeof(query));
+    }
 
-    for (const auto& scene_name : scene_names) {
-        fs::path scene_path = args.data_dir / scene_name / sub_folder;
-        if (!fs::exists(scene_path)) {
-            std::cout << "Missing: " << scene_path.string() << std::endl;
-            continue;
+    Eigen::Matrix<double, 8, 3> V;
+    double time, toi;
+    AllocationCounts& allocations = thread_allocation_counts();
+    const AllocationCounts allocations_before = allocations;
+    allocations.peak_live_bytes = allocations.live_bytes;
+    uint64_t counts_before[NUM_PERF_EVENTS];
+    if (counters != nullptr) {
+        counters->counters.read(counts_before);
+    }
+    const bool result = time_ccd_query(
+        args, method, is_edge_edge, query, V, time,
+        args.is_sweep() ? &toi : nullptr);
+    if (args.count_allocations) {
+        const uint64_t num_allocations
+            = allocations.num_allocations - allocations_before.num_allocations;
+        stats.num_allocations += num_allocations;
+        stats.allocated_bytes += allocations.bytes - allocations_before.bytes;
+        stats.num_allocating_queries += num_allocations > 0;
+        stats.peak_live_bytes = std::max(
+            stats.peak_live_bytes,
+            allocations.peak_live_bytes - allocations_before.live_bytes);
+    }
+    uint64_t counts[NUM_PERF_EVENTS];
+    const bool is_counted
+        = counters != nullptr && counters->counters.read(counts);
+    if (is_counted) {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            counts[e] -= counts_before[e];
+            counts[e] -= std::min(counts[e], counters->overhead[e]);
+        }
+        stats.counters.add(counters->counters, counts);
+    }
+    if (stats.is_slowest(time, args.num_slowest)) {
+        SlowQuery slow_query;
+        slow_query.time = time;
+        slow_query.path = path.string();
+        slow_query.index = index;
+        slow_query.query = query;
+        slow_query.result = result;
+        slow_query.expected_result = expected_result;
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            slow_query.counts[e]
+                = is_counted && counters->counters.is_available(PerfEvent(e))
+                ? double(counts[e])
+                : NAN;
+        }
+        stats.keep_slowest(slow_query, args.num_slowest);
+    }
+    stats.total_time += time / 1000;
+    stats.latency.add(time);
+    if (args.sample_size > 0) {
+        stats.class_latency[expected_result].add(time);
+        stats.class_time[expected_result] += time;
+        stats.class_time_squared[expected_result] += time * time;
+    }
+    stats.num_queries++;
+    if (args.is_sweep()) {
+        stats.tois.push_back(toi);
+    }
+    if (args.preprocessing != NO_PREPROCESSING) {
+        stats.preprocessed_size.add(V);
+    }
+#if CCD_WRAPPER_WITH_RP_FILTER
+    const root_parity::FilterStatistics filter_stats
+        = root_parity::filter_statistics();
+    stats.num_filtered += filter_stats.num_queries
+        - filter_stats_before.num_queries;
+    stats.num_certified += filter_stats.num_certified
+        - filter_stats_before.num_certified;
+#endif
+
+    // The same query again, now that it and the method are in cache
+    if (args.cache_mode != WARM_CACHE) {
+        double warm_time;
+        time_ccd_query(args, method, is_edge_edge, query, V, warm_time);
+        stats.warm_latency.add(warm_time);
+    }
+
+    if (expected_result) {
+        stats.num_positives++;
+    }
+    if (result != expected_result) {
+        if (result) {
+            stats.num_false_positives++;
+        } else {
+            stats.num_false_negatives++;
         }
+    }
+    return result;
+}
 
-        for (const auto& entry : fs::directory_iterator(scene_path)) {
-            if (entry.path().extension() != ".csv") {
+/// Scene of a query file (<data>/<scene>/<vertex-face|edge-edge>/<file>).
+std::string scene_name(const fs::path& path)
+{
+    return path.parent_path().parent_path().filename().string();
+}
+
+/// Seed (for a std::seed_seq) of the sample of a file's or scene's queries
+/// with a ground truth, the same for every method so they run the same
+/// queries.
+std::vector<uint32_t> sample_seed(
+    const CLIArgs& args, const std::string& key, const int result)
+{
+    std::vector<uint32_t> seed(key.begin(), key.end());
+    seed.push_back(args.seed);
+    seed.push_back(uint32_t(result));
+    return seed;
+}
+
+/// Open the queries of a task, reading ahead on a background thread if
+/// there is a core to spare. The spare cores are split between the threads
+/// running tasks to parse CSV blocks. Only the queries of the task's range
+/// and sample (see QueryBlock::is_selected) are read.
+/// @return nullptr if the file cannot be read.
+std::unique_ptr<PrefetchedQueryStream>
+open_benchmark_task(const CLIArgs& args, const BenchmarkTask& task)
+{
+    const int num_threads = std::max(args.num_threads, 1);
+    const int num_spare_cores
+        = std::max(int(std::thread::hardware_concurrency()) - num_threads, 0);
+
+    // The queries of the range and, with --sample, of each ground truth to
+    // run
+    QueryFilter filter;
+    if (args.sample_size > 0 || task.max_queries > 0) {
+        const std::string seed_key = task.max_queries > 0
+            ? task.path.string() + ":" + std::to_string(task.start.query)
+            : task.path.string();
+        const std::shared_ptr<std::vector<SequentialSampler>> samplers(
+            new std::vector<SequentialSampler>());
+        for (int c = 0; c < 2 && args.sample_size > 0; c++) {
+            const auto seed_values = sample_seed(args, seed_key, c);
+            std::seed_seq seed(seed_values.begin(), seed_values.end());
+            samplers->emplace_back(
+                task.num_queries[c], task.sample_size[c], seed);
+        }
+        const size_t end_query = task.max_queries > 0
+            ? size_t(task.start.query + task.max_queries)
+            : std::numeric_limits<size_t>::max();
+        filter = [samplers, end_query](size_t index, bool result) {
+            return index < end_query
+                && (samplers->empty() || (*samplers)[result].next());
+        };
+    }
+
+    try {
+        return std::unique_ptr<PrefetchedQueryStream>(new PrefetchedQueryStream(
+            task.path.string(), /*block_size=*/4096,
+            /*depth=*/args.prefetch && num_spare_cores > 0 ? 2 : 0,
+            /*num_threads=*/std::max(num_spare_cores / num_threads, 1),
+            task.start, filter));
+    } catch (const char* err) {
+        std::cerr << "Could not read file " << task.path.string() << ": "
+                  << err << std::endl;
+        return nullptr;
+    }
+}
+
+/// Run and time every query of a query file with every method of the task.
+/// @param stream    Queries of the task (see open_benchmark_task), or nullptr.
+/// @param progress  Running count of queries to print, or nullptr.
+MethodsResults run_benchmark_task(
+    const CLIArgs& args,
+    const BenchmarkTask& task,
+    PrefetchedQueryStream* stream,
+    long* progress)
+{
+    const size_t num_methods = task.methods.size();
+    MethodsResults stats(num_methods);
+    if (stream == nullptr) {
+        return stats;
+    }
+
+    // Queries are read in blocks, so memory does not grow with the file.
+    // Only the CCD calls are timed, not reading the next block.
+    QueryBlock block;
+    std::vector<bool> results(num_methods), is_run(num_methods);
+
+    // Counters are per thread, so each task opens its own.
+    std::unique_ptr<QueryCounters> counters;
+    if (args.perf_counters) {
+        counters.reset(new QueryCounters());
+        static std::atomic<bool> is_reported(false);
+        if (!counters->counters.error().empty()
+            && !is_reported.exchange(true)) {
+            std::cerr << "warning: some hardware counters are unavailable: "
+                      << counters->counters.error() << std::endl;
+        }
+        if (!counters->counters.is_any_available()) {
+            counters.reset();
+        }
+    }
+
+    std::unique_ptr<CacheEvictor> evictor;
+    if (args.cache_mode == COLD_CACHE) {
+        evictor.reset(new CacheEvictor());
+    }
+
+    // Run the methods on query i of the file.
+    const auto run_methods = [&](const Eigen::Matrix<double, 8, 3>& query,
+                                 const bool expected_result, const size_t i) {
+        Eigen::Matrix<double, 8, 3> quantized;
+        if (args.quantization_bits >= 0) {
+            quantized = quantize(query, args.quantization_bits);
+        }
+        const Eigen::Matrix<double, 8, 3>& V
+            = args.quantization_bits >= 0 ? quantized : query;
+
+        for (size_t k = 0; k < num_methods; k++) {
+            const CCDMethod method = task.methods[k];
+            is_run[k] = is_query_supported(args, method, V);
+            if (!is_run[k]) {
+                stats.methods[k].num_skipped++;
                 continue;
             }
+            results[k] = run_query(
+                args, method, task.is_edge_edge, V, expected_result,
+                task.path, i, stats.methods[k], counters.get(), evictor.get());
+            if (method == CCDMethod::TIGHT_INCLUSION && expected_result
+                && !results[k]) {
+                stats.tight_inclusion_false_negative = fmt::format(
+                    "false negative, {:s}, {:d}\nis edge-edge? {}",
+                    task.path.string(), i, task.is_edge_edge);
+                return;
+            }
+        }
+        stats.agreement.add(results, is_run, task.path, i);
 
-            // std::cout << "reading data from " << entry.path().string()
-            //           << std::endl;
-            all_V = read_rational_csv(entry.path().string(), results);
-            assert(all_V.rows() % 8 == 0 && all_V.cols() == 3);
-
-            int v_size = all_V.rows() / 8;
-            for (int i = 0; i < v_size; i++) {
-                total_number += 1;
-                Eigen::Matrix<double, 8, 3> V = all_V.middleRows<8>(8 * i);
-                bool expected_result = results[i * 8];
-
-                bool result;
-                timer.start();
-                if (use_msccd) {
-                    if (is_edge_edge) {
-                        result = edgeEdgeMSCCD(
-                            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
-                            V.row(5), V.row(6), V.row(7),
-                            args.minimum_separation, method,
-                            args.tight_inclusion_tolerance,
-                            args.tight_inclusion_max_iter);
-                    } else {
-                        result = vertexFaceMSCCD(
-                            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
-                            V.row(5), V.row(6), V.row(7),
-                            args.minimum_separation, method,
-                            args.tight_inclusion_tolerance,
-                            args.tight_inclusion_max_iter);
-                    }
-                } else {
-                    if (is_edge_edge) {
-                        result = edgeEdgeCCD(
-                            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
-                            V.row(5), V.row(6), V.row(7), method,
-                            args.tight_inclusion_tolerance,
-                            args.tight_inclusion_max_iter);
-                    } else {
-                        result = vertexFaceCCD(
-                            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
-                            V.row(5), V.row(6), V.row(7), method,
-                            args.tight_inclusion_tolerance,
-                            args.tight_inclusion_max_iter);
-                    }
-                }
-                timer.stop();
-                total_time += timer.getElapsedTimeInMicroSec();
 #ifndef CCD_WRAPPER_IS_CI_BUILD
-                std::cout << total_number << "\r" << std::flush;
+        if (progress != nullptr) {
+            std::cout << (*progress)++ << "\r" << std::flush;
+        }
 #endif
+    };
+
+    const auto is_stopped = [&]() {
+        return !stats.tight_inclusion_false_negative.empty();
+    };
 
-                if (expected_result) {
-                    total_positives++;
+    // Read the next block of the task's queries.
+    uint64_t num_left = task.max_queries > 0
+        ? task.max_queries
+        : std::numeric_limits<uint64_t>::max();
+    const auto next_block = [&]() {
+        if (num_left == 0 || !stream->next(block)) {
+            return false;
+        }
+        if (block.size() > num_left) {
+            block.queries.resize(num_left);
+        }
+        num_left -= block.size();
+        return true;
+    };
+
+    if (args.cache_mode != SHUFFLED_QUERIES) {
+        for (size_t i = task.start.query; !is_stopped() && next_block();) {
+            for (size_t j = 0; j < block.size() && !is_stopped(); i++, j++) {
+                if (block.is_selected(j)) {
+                    run_methods(block.queries[j], block.result(j), i);
                 }
-                if (result != expected_result) {
-                    if (result) {
-                        num_false_positives++;
-                    } else {
-                        num_false_negatives++;
-                        if (method == CCDMethod::TIGHT_INCLUSION) {
-                            fmt::print(
-                                "false negative, {:s}, {:d}\nis edge-edge? {}",
-                                entry.path().string(), i, is_edge_edge);
-                            exit(1);
-                        }
-                    }
+            }
+        }
+        return stats;
+    }
+
+    // Gather a working set larger than the caches and run it in a random
+    // (but fixed) order, so consecutive queries are far apart in memory.
+    const size_t working_set_size = std::max<size_t>(
+        1,
+        (size_t(args.working_set_mib) << 20)
+            / sizeof(Eigen::Matrix<double, 8, 3>));
+    decltype(block.queries) working_set;
+    std::vector<bool> working_set_results;
+    std::vector<size_t> working_set_indices, order;
+    std::mt19937 rng(0);
+    for (size_t i = task.start.query;;) {
+        working_set.clear();
+        working_set_results.clear();
+        working_set_indices.clear();
+        while (working_set.size() < working_set_size && next_block()) {
+            for (size_t j = 0; j < block.size(); i++, j++) {
+                if (block.is_selected(j)) {
+                    working_set.push_back(block.queries[j]);
+                    working_set_results.push_back(block.result(j));
+                    working_set_indices.push_back(i);
                 }
             }
         }
+        if (working_set.empty()) {
+            break;
+        }
+        order.resize(working_set.size());
+        for (size_t j = 0; j < order.size(); j++) {
+            order[j] = j;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        for (size_t j : order) {
+            run_methods(
+                working_set[j], working_set_results[j],
+                working_set_indices[j]);
+            if (is_stopped()) {
+                return stats;
+            }
+        }
     }
 
-    fmt::print(
-        "total # of queries: {:d}\n"
-        "total positives: {:d}\n"
-        "# of false positives: {}\n"
-        "# of false negatives: {}\n"
-        "average time: {:g}μs\n\n",
-        total_number + 1, total_positives,
-        fmt::format(
-            fmt::fg(
-                num_false_positives ? fmt::terminal_color::yellow
-                                    : fmt::terminal_color::green),
-            "{:d}", num_false_positives),
-        fmt::format(
-            fmt::fg(
-                num_false_negatives ? fmt::terminal_color::red
-                                    : fmt::terminal_color::green),
-            "{:d}", num_false_negatives),
-        total_time / double(total_number + 1));
+    return stats;
 }
 
-void run_one_method_over_all_data(const CLIArgs& args, const CCDMethod method)
+/// Scenes (directories with vertex-face or edge-edge queries) in the data
+/// directory, sorted by name.
+std::vector<std::string> discover_scenes(const fs::path& data_dir)
 {
-    if (args.run_handcrafted_dataset) {
-        fmt::print(fmt::emphasis::bold, "Running handcrafted dataset:\n");
-        if (args.run_vf_dataset) {
-            std::cout << "Vertex-Face:" << std::endl;
-            run_rational_data_single_method(
-                args, method, /*is_edge_edge=*/false, /*is_simu_data=*/false);
-        }
-        if (args.run_ee_dataset) {
-            std::cout << "Edge-Edge:" << std::endl;
-            run_rational_data_single_method(
-                args, method, /*is_edge_edge=*/true, /*is_simu_data=*/false);
-        }
+    std::vector<std::string> scenes;
+    if (!fs::is_directory(data_dir)) {
+        return scenes;
     }
-    if (args.run_simulation_dataset) {
-        fmt::print(fmt::emphasis::bold, "Running simulation dataset:\n");
-        if (args.run_vf_dataset) {
-            std::cout << "Vertex-Face:" << std::endl;
-            run_rational_data_single_method(
-                args, method, /*is_edge_edge=*/false, /*is_simu_data=*/true);
-        }
-        if (args.run_ee_dataset) {
-            std::cout << "Edge-Edge:" << std::endl;
-            run_rational_data_single_method(
-                args, method, /*is_edge_edge=*/true, /*is_simu_data=*/true);
+    for (const auto& entry : fs::directory_iterator(data_dir)) {
+        if (fs::is_directory(entry.path() / "vertex-face")
+            || fs::is_directory(entry.path() / "edge-edge")) {
+            scenes.push_back(entry.path().filename().string());
         }
     }
+    std::sort(scenes.begin(), scenes.end());
+    return scenes;
 }
 
-void run_all_methods(const CLIArgs& args)
+/// Whether the text matches one of the patterns, or there are none.
+bool matches_any(
+    const std::vector<std::string>& patterns, const std::string& text)
 {
-    for (CCDMethod method : args.methods) {
-        if (is_method_enabled(method)) {
-            fmt::print(
-                fmt::emphasis::bold | fmt::emphasis::underline,
+    return patterns.empty()
+        || std::any_of(
+               patterns.begin(), patterns.end(),
+               [&](const std::string& pattern) {
+                   return glob_match(pattern, text);
+               });
+}
+
+/// List the query files of a dataset in a fixed (sorted) order.
+BenchmarkGroup plan_benchmark_group(
+    const CLIArgs& args,
+    const std::vector<CCDMethod>& methods,
+    const bool is_edge_edge,
+    const bool is_simulation_data,
+    std::vector<BenchmarkTask>& tasks)
+{
+    BenchmarkGroup group;
+    group.methods = methods;
+    group.is_edge_edge = is_edge_edge;
+    group.is_simulation_data = is_simulation_data;
+    group.first_task = tasks.size();
+
+    std::string sub_folder = is_edge_edge ? "edge-edge" : "vertex-face";
+
+    for (const std::string& scene_name : discover_scenes(args.data_dir)) {
+        const bool is_simulation_scene
+            = std::find(
+                  simulation_folders.begin(), simulation_folders.end(),
+                  scene_name)
+            != simulation_folders.end();
+        const fs::path scene_path = args.data_dir / scene_name / sub_folder;
+        if (is_simulation_scene != is_simulation_data
+            || !matches_any(args.scene_patterns, scene_name)
+            || !fs::is_directory(scene_path)) {
+            continue;
+        }
+
+        // Prefer a binary file over the CSV it was converted from.
+        std::vector<fs::path> paths;
+        for (const auto& entry : fs::directory_iterator(scene_path)) {
+            fs::path binary_path = entry.path();
+            binary_path.replace_extension(BINARY_QUERIES_EXTENSION);
+            const std::string relative_path = scene_name + "/" + sub_folder
+                + "/" + entry.path().filename().string();
+            if ((entry.path().extension() == BINARY_QUERIES_EXTENSION
+                 || (entry.path().extension() == ".csv"
+                     && !fs::exists(binary_path)))
+                && matches_any(args.file_patterns, relative_path)) {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+
+        for (const fs::path& path : paths) {
+            tasks.push_back({ methods, is_edge_edge, path });
+        }
+    }
+
+    group.end_task = tasks.size();
+    return group;
+}
+
+/// Count the negative and positive queries of every task and choose which
+/// to run: a sample of args.sample_size queries per group, allocated to the
+/// scenes and ground truths in proportion to their number of queries.
+void plan_sample(
+    const CLIArgs& args,
+    std::vector<BenchmarkTask>& tasks,
+    const std::vector<BenchmarkGroup>& groups)
+{
+    // The methods share the files, and ranges are counted when split.
+    std::map<std::string, std::pair<uint64_t, uint64_t>> counts;
+    for (BenchmarkTask& task : tasks) {
+        if (task.max_queries > 0) {
+            continue;
+        }
+        const auto count = counts.find(task.path.string());
+        if (count != counts.end()) {
+            task.num_queries[0] = count->second.first;
+            task.num_queries[1] = count->second.second;
+            continue;
+        }
+        try {
+            // Only the ground truth is read, not the coordinates.
+            QueryStream stream(
+                task.path.string(), /*block_size=*/4096, /*num_threads=*/1,
+                [&](size_t, bool result) {
+                    task.num_queries[result]++;
+                    return false;
+                });
+            QueryBlock block;
+            while (stream.next(block)) { }
+        } catch (const char* err) {
+            // Reported when the task runs
+        }
+        counts[task.path.string()]
+            = std::make_pair(task.num_queries[0], task.num_queries[1]);
+    }
+
+    for (const BenchmarkGroup& group : groups) {
+        // Strata of scene and ground truth; the tasks of a scene are
+        // consecutive.
+        std::vector<std::pair<size_t, size_t>> scenes; // task ranges
+        for (size_t i = group.first_task; i < group.end_task; i++) {
+            if (scenes.empty()
+                || scene_name(tasks[i].path)
+                    != scene_name(tasks[scenes.back().first].path)) {
+                scenes.emplace_back(i, i);
+            }
+            scenes.back().second = i + 1;
+        }
+        std::vector<uint64_t> stratum_sizes(2 * scenes.size(), 0);
+        for (size_t s = 0; s < scenes.size(); s++) {
+            for (size_t i = scenes[s].first; i < scenes[s].second; i++) {
+                stratum_sizes[2 * s] += tasks[i].num_queries[0];
+                stratum_sizes[2 * s + 1] += tasks[i].num_queries[1];
+            }
+        }
+        const std::vector<uint64_t> sample_sizes
+            = allocate_sample(stratum_sizes, args.sample_size);
+
+        // Spread the sample of a stratum uniformly over its files.
+        for (size_t h = 0; h < stratum_sizes.size(); h++) {
+            const int result = int(h % 2);
+            const auto seed_values = sample_seed(
+                args, scene_name(tasks[scenes[h / 2].first].path), result);
+            std::seed_seq seed(seed_values.begin(), seed_values.end());
+            SequentialSampler sampler(
+                stratum_sizes[h], sample_sizes[h], seed);
+            for (size_t i = scenes[h / 2].first; i < scenes[h / 2].second;
+                 i++) {
+                for (uint64_t j = 0; j < tasks[i].num_queries[result]; j++) {
+                    tasks[i].sample_size[result] += sampler.next();
+                }
+            }
+        }
+    }
+}
+
+/// Keep only the files of this --shard: every n-th file of each group,
+/// the same files for every method.
+void select_shard(
+    const CLIArgs& args,
+    std::vector<BenchmarkTask>& tasks,
+    std::vector<BenchmarkGroup>& groups)
+{
+    std::vector<BenchmarkTask> shard_tasks;
+    for (BenchmarkGroup& group : groups) {
+        const size_t first_task = shard_tasks.size();
+        for (size_t i = group.first_task; i < group.end_task; i++) {
+            if ((i - group.first_task) % args.num_shards
+                == size_t(args.shard_index)) {
+                shard_tasks.push_back(tasks[i]);
+            }
+        }
+        group.first_task = first_task;
+        group.end_task = shard_tasks.size();
+    }
+    tasks.swap(shard_tasks);
+}
+
+/// Plan a group per enabled dataset for the methods.
+void plan_benchmark_groups(
+    const CLIArgs& args,
+    const std::vector<CCDMethod>& methods,
+    std::vector<BenchmarkTask>& tasks,
+    std::vector<BenchmarkGroup>& groups)
+{
+    for (const bool is_simulation_data : { false, true }) {
+        if (!(is_simulation_data ? args.run_simulation_dataset
+                                 : args.run_handcrafted_dataset)) {
+            continue;
+        }
+        if (args.run_vf_dataset) {
+            groups.push_back(plan_benchmark_group(
+                args, methods, /*is_edge_edge=*/false, is_simulation_data,
+                tasks));
+        }
+        if (args.run_ee_dataset) {
+            groups.push_back(plan_benchmark_group(
+                args, methods, /*is_edge_edge=*/true, is_simulation_data,
+                tasks));
+        }
+    }
+}
+
+/// Tight Inclusion is conservative, so a false negative is a bug: print the
+/// first one found and exit. Only call it when no thread is running queries,
+/// since exiting destroys the static objects they use.
+void exit_on_tight_inclusion_false_negative(
+    const std::vector<MethodsResults>& task_results)
+{
+    for (const MethodsResults& results : task_results) {
+        if (!results.tight_inclusion_false_negative.empty()) {
+            fmt::print("{}", results.tight_inclusion_false_negative);
+            exit(1);
+        }
+    }
+}
+
+/// Run the tasks on args.num_threads threads.
+/// @param cpus          CPUs to pin the threads to in turn, or none.
+/// @param thread_times  Time of the CCD calls (μs) of each thread, or nullptr.
+void run_benchmark_tasks(
+    const CLIArgs& args,
+    const std::vector<BenchmarkTask>& tasks,
+    const std::vector<BenchmarkGroup>& groups,
+    std::vector<MethodsResults>& task_results,
+    const std::vector<int>& cpus = {},
+    std::vector<double>* thread_times = nullptr)
+{
+    task_results.resize(tasks.size());
+    if (thread_times != nullptr) {
+        thread_times->assign(args.num_threads, 0);
+    }
+    // Set once a task found a Tight Inclusion false negative
+    std::atomic<bool> is_stopped(false);
+
+    if (args.num_threads <= 1 && cpus.empty() && thread_times == nullptr) {
+        // Start reading the next file while the current one runs.
+        std::unique_ptr<PrefetchedQueryStream> next_stream;
+        if (!tasks.empty()) {
+            next_stream = open_benchmark_task(args, tasks[0]);
+        }
+        for (const BenchmarkGroup& group : groups) {
+            long progress = 0;
+            for (size_t i = group.first_task;
+                 i < group.end_task && !is_stopped; i++) {
+                std::unique_ptr<PrefetchedQueryStream> stream
+                    = std::move(next_stream);
+                if (i + 1 < tasks.size()) {
+                    next_stream = open_benchmark_task(args, tasks[i + 1]);
+                }
+                task_results[i] = run_benchmark_task(
+                    args, tasks[i], stream.get(), &progress);
+                is_stopped
+                    = !task_results[i].tight_inclusion_false_negative.empty();
+            }
+        }
+        // Stop reading ahead before exiting.
+        next_stream.reset();
+        exit_on_tight_inclusion_false_negative(task_results);
+        return;
+    }
+
+    // Start the largest files first so no thread is left with a long tail.
+    std::vector<size_t> order(tasks.size());
+    std::vector<uintmax_t> file_sizes(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        order[i] = i;
+        file_sizes[i] = fs::file_size(tasks[i].path);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return file_sizes[a] > file_sizes[b];
+    });
+
+    // Each thread times its own queries; the results are only combined after
+    // all threads finished, in the order of the tasks.
+    std::atomic<size_t> next_task(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < args.num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            if (!cpus.empty()) {
+                pin_thread_to_cpu(cpus[t % cpus.size()]);
+            }
+            for (size_t i; !is_stopped && (i = next_task++) < order.size();) {
+                const BenchmarkTask& task = tasks[order[i]];
+                task_results[order[i]] = run_benchmark_task(
+                    args, task, open_benchmark_task(args, task).get(), nullptr);
+                if (!task_results[order[i]]
+                         .tight_inclusion_false_negative.empty()) {
+                    is_stopped = true;
+                }
+                if (thread_times != nullptr) {
+                    for (const BenchmarkResults& results :
+                         task_results[order[i]].methods) {
+                        (*thread_times)[t] += results.total_time;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    exit_on_tight_inclusion_false_negative(task_results);
+}
+
+std::string format_latency(const LatencyHistogram& latency)
+{
+    return fmt::format(
+        "min {:.0f}ns, p50 {:.0f}ns, p90 {:.0f}ns, p99 {:.0f}ns, "
+        "p99.9 {:.0f}ns, max {:.0f}ns",
+        latency.min(), latency.percentile(0.5), latency.percentile(0.9),
+        latency.percentile(0.99), latency.percentile(0.999), latency.max());
+}
+
+void print_benchmark_results(
+    const CLIArgs& args, const BenchmarkResults& results)
+{
+    fmt::print(
+        "total # of queries: {:d}\n"
+        "total positives: {:d}\n"
+        "# of false positives: {}\n"
+        "# of false negatives: {}\n"
+        "average time: {:g}μs\n"
+        "latency: {}\n",
+        results.num_queries, results.num_positives,
+        fmt::format(
+            fmt::fg(
+                results.num_false_positives ? fmt::terminal_color::yellow
+                                            : fmt::terminal_color::green),
+            "{:d}", results.num_false_positives),
+        fmt::format(
+            fmt::fg(
+                results.num_false_negatives ? fmt::terminal_color::red
+                                            : fmt::terminal_color::green),
+            "{:d}", results.num_false_negatives),
+        results.total_time / double(results.num_queries),
+        format_latency(results.latency));
+    if (results.warm_latency.size() > 0) {
+        fmt::print(
+            "latency of the same queries again (warm): {}\n",
+            format_latency(results.warm_latency));
+    }
+    std::cout << std::endl;
+
+    if (args.preprocessing != NO_PREPROCESSING && results.num_queries > 0) {
+        const double n = 24.0 * results.num_queries;
+        fmt::print(
+            "coordinate size as rationals: {:.1f} -> {:.1f} bits, "
+            "{:.2f} -> {:.2f} limbs (avg. per coordinate)\n\n",
+            results.original_size.bits / n, results.preprocessed_size.bits / n,
+            results.original_size.limbs / n,
+            results.preprocessed_size.limbs / n);
+    }
+
+    if (results.num_skipped > 0) {
+        fmt::print(
+            fmt::fg(fmt::terminal_color::yellow),
+            "{:d} queries exceed the input range of the method and were "
+            "skipped (for the fixed-point method, try --quantize or "
+            "--preprocess translate)\n\n",
+            results.num_skipped);
+    }
+
+    if (args.quantization_bits >= 0) {
+        fmt::print(
+            "note: queries were quantized to 2^-{:d}, but the false "
+            "positives/negatives are relative to the unquantized ground "
+            "truth\n\n",
+            args.quantization_bits);
+    }
+
+    if (!results.counters.empty()) {
+        const auto count = [&](PerfEvent event) {
+            const double average = results.counters.average(event);
+            return std::isnan(average) ? std::string("n/a")
+                                       : fmt::format("{:.1f}", average);
+        };
+        fmt::print(
+            "hardware counters per query: {} cycles, {} instructions "
+            "(IPC {:.2f}), {} branch misses, {} L1D read misses, {} LLC read "
+            "misses\n\n",
+            count(CYCLES), count(INSTRUCTIONS), results.counters.ipc(),
+            count(BRANCH_MISSES), count(L1D_READ_MISSES),
+            count(LLC_READ_MISSES));
+    }
+
+    if (args.count_allocations && results.num_queries > 0) {
+        fmt::print(
+            "heap allocations per query: {:.2f} ({:.0f} bytes), {:.2f}% of "
+            "the queries allocate, at most {:d} bytes live in a query\n\n",
+            double(results.num_allocations) / results.num_queries,
+            double(results.allocated_bytes) / results.num_queries,
+            100.0 * results.num_allocating_queries / results.num_queries,
+            results.peak_live_bytes);
+    }
+
+    // Queries decided in double without touching the exact arithmetic
+    if (results.num_filtered > 0) {
+        fmt::print(
+            "filter success rate: {:d}/{:d} ({:.2f}%)\n\n",
+            results.num_certified, results.num_filtered,
+            100.0 * results.num_certified / results.num_filtered);
+    }
+}
+
+/// Results of a group per scene, in the order of its tasks.
+std::vector<std::pair<std::string, MethodsResults>> merge_scenes(
+    const BenchmarkGroup& group,
+    const std::vector<BenchmarkTask>& tasks,
+    const std::vector<MethodsResults>& task_results)
+{
+    std::vector<std::pair<std::string, MethodsResults>> scenes;
+    for (size_t i = group.first_task; i < group.end_task; i++) {
+        const std::string scene = scene_name(tasks[i].path);
+        if (scenes.empty() || scenes.back().first != scene) {
+            scenes.emplace_back(scene, MethodsResults(group.methods.size()));
+        }
+        scenes.back().second.merge(task_results[i]);
+    }
+    return scenes;
+}
+
+/// Print the latency of the k-th method of a group per scene.
+void print_scene_latencies(
+    const std::vector<std::pair<std::string, MethodsResults>>& scenes,
+    const size_t k)
+{
+    if (scenes.size() < 2) {
+        return; // same as the total
+    }
+    for (const auto& scene : scenes) {
+        fmt::print(
+            "  {}: {}\n", scene.first,
+            format_latency(scene.second.methods[k].latency));
+    }
+    std::cout << std::endl;
+}
+
+/// With --sample, print the latency of all queries of a group estimated
+/// from the sample of the k-th method.
+void print_sample_estimates(
+    const CLIArgs& args,
+    const BenchmarkGroup& group,
+    const std::vector<BenchmarkTask>& tasks,
+    const std::vector<MethodsResults>& task_results,
+    const size_t k)
+{
+    if (args.sample_size == 0 || group.first_task == group.end_task) {
+        return;
+    }
+    // A stratum per scene and ground truth
+    std::vector<SampledStratum> strata;
+    uint64_t population_size = 0;
+    for (size_t i = group.first_task; i < group.end_task; i++) {
+        if (i == group.first_task
+            || scene_name(tasks[i].path) != scene_name(tasks[i - 1].path)) {
+            strata.resize(strata.size() + 2);
+        }
+        const BenchmarkResults& results = task_results[i].methods[k];
+        for (int c = 0; c < 2; c++) {
+            SampledStratum& stratum = strata[strata.size() - 2 + c];
+            stratum.population_size += tasks[i].num_queries[c];
+            stratum.latency.merge(results.class_latency[c]);
+            stratum.sum += results.class_time[c];
+            stratum.sum_squared += results.class_time_squared[c];
+            population_size += tasks[i].num_queries[c];
+        }
+    }
+
+    const auto format_estimate = [](const Estimate& estimate) {
+        return fmt::format(
+            "{:.0f}ns [{:.0f}, {:.0f}]", estimate.value, estimate.lower,
+            estimate.upper);
+    };
+    fmt::print(
+        "estimated for all {:d} queries (95% confidence): mean {}, "
+        "p50 {}, p90 {}, p99 {}\n",
+        population_size, format_estimate(estimate_mean(strata)),
+        format_estimate(estimate_percentile(strata, 0.5)),
+        format_estimate(estimate_percentile(strata, 0.9)),
+        format_estimate(estimate_percentile(strata, 0.99)));
+}
+
+BenchmarkRecord make_benchmark_record(
+    const BenchmarkGroup& group,
+    const CCDMethod method,
+    const std::string& scene,
+    const BenchmarkResults& results)
+{
+    BenchmarkRecord record;
+    record.method = method_names[method];
+    record.dataset = group.is_simulation_data ? "simulation" : "handcrafted";
+    record.query_type = group.is_edge_edge ? "edge-edge" : "vertex-face";
+    record.scene = scene;
+    record.num_queries = results.num_queries;
+    record.num_positives = results.num_positives;
+    record.num_false_positives = results.num_false_positives;
+    record.num_false_negatives = results.num_false_negatives;
+    record.num_skipped = results.num_skipped;
+    record.average_time = 1e3 * results.total_time / results.num_queries;
+    record.latency = summarize_latency(results.latency);
+    record.warm_latency = summarize_latency(results.warm_latency);
+    record.latency_histogram = results.latency;
+    record.warm_latency_histogram = results.warm_latency;
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        record.counters[e] = results.counters.average(PerfEvent(e));
+    }
+    if (is_counting_allocations() && results.num_queries > 0) {
+        record.allocations
+            = double(results.num_allocations) / results.num_queries;
+        record.allocated_bytes
+            = double(results.allocated_bytes) / results.num_queries;
+        record.peak_live_bytes = double(results.peak_live_bytes);
+    }
+    return record;
+}
+
+/// Build, machine, and options of this run.
+std::vector<std::pair<std::string, std::string>>
+benchmark_fingerprint(const CLIArgs& args)
+{
+    std::vector<std::pair<std::string, std::string>> fingerprint;
+#if defined(__clang__)
+    fingerprint.emplace_back("compiler", "clang " __clang_version__);
+#elif defined(__GNUC__)
+    fingerprint.emplace_back("compiler", "gcc " __VERSION__);
+#elif defined(_MSC_VER)
+    fingerprint.emplace_back("compiler", fmt::format("msvc {}", _MSC_VER));
+#else
+    fingerprint.emplace_back("compiler", "unknown");
+#endif
+    fingerprint.emplace_back("build_type", CCD_WRAPPER_BUILD_TYPE);
+#ifdef NDEBUG
+    fingerprint.emplace_back("assertions", "off");
+#else
+    fingerprint.emplace_back("assertions", "on");
+#endif
+    fingerprint.emplace_back("cpu", cpu_model_name());
+    fingerprint.emplace_back(
+        "hardware_threads",
+        std::to_string(std::thread::hardware_concurrency()));
+    fingerprint.emplace_back(
+        "timer_overhead_ns", fmt::format("{:.0f}", timer_overhead));
+
+    std::string methods;
+    for (CCDMethod method : args.methods) {
+        methods += methods.empty() ? "" : ",";
+        methods += method_names[method];
+    }
+    fingerprint.emplace_back("methods", methods);
+    fingerprint.emplace_back("data", args.data_dir.string());
+    fingerprint.emplace_back("threads", std::to_string(args.num_threads));
+    fingerprint.emplace_back(
+        "single_pass", args.single_pass ? "true" : "false");
+    fingerprint.emplace_back(
+        "perf_counters", args.perf_counters ? "true" : "false");
+    fingerprint.emplace_back(
+        "allocations", args.count_allocations ? "true" : "false");
+    fingerprint.emplace_back(
+        "cache",
+        args.cache_mode == WARM_CACHE
+            ? "warm"
+            : (args.cache_mode == COLD_CACHE
+                   ? "cold"
+                   : fmt::format("shuffled ({} MiB)", args.working_set_mib)));
+    const auto join = [](const std::vector<std::string>& patterns) {
+        std::string joined;
+        for (const std::string& pattern : patterns) {
+            joined += (joined.empty() ? "" : ",") + pattern;
+        }
+        return joined;
+    };
+    if (args.num_shards > 1) {
+        fingerprint.emplace_back(
+            "shard",
+            fmt::format("{}/{}", args.shard_index + 1, args.num_shards));
+    }
+    fingerprint.emplace_back("scenes", join(args.scene_patterns));
+    fingerprint.emplace_back("files", join(args.file_patterns));
+    if (args.sample_size > 0) {
+        fingerprint.emplace_back(
+            "sample",
+            fmt::format("{} (seed {})", args.sample_size, args.seed));
+    }
+    if (!args.scaling_threads.empty()) {
+        fingerprint.emplace_back("numa", args.numa_aware ? "true" : "false");
+    }
+    fingerprint.emplace_back(
+        "preprocess",
+        args.preprocessing == NO_PREPROCESSING
+            ? "none"
+            : (args.preprocessing == TRANSLATE ? "translate" : "rescale"));
+    fingerprint.emplace_back(
+        "quantize", std::to_string(args.quantization_bits));
+    fingerprint.emplace_back(
+        "minimum_separation", fmt::format("{:g}", args.minimum_separation));
+    fingerprint.emplace_back(
+        "ti_tolerance", fmt::format("{:g}", args.tight_inclusion_tolerance));
+    fingerprint.emplace_back(
+        "ti_max_iter", std::to_string(args.tight_inclusion_max_iter));
+
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    fingerprint.emplace_back("date", date);
+    return fingerprint;
+}
+
+/// Print how often each pair of methods disagrees, and where first.
+void print_agreement_matrix(
+    const std::vector<CCDMethod>& methods, const AgreementMatrix& agreement)
+{
+    const size_t n = methods.size();
+    size_t name_width = 0;
+    for (CCDMethod method : methods) {
+        name_width = std::max(name_width, std::strlen(method_names[method]));
+    }
+
+    fmt::print(
+        fmt::emphasis::bold,
+        "disagreements between methods (# of queries):\n");
+    fmt::print("{:{}}", "", name_width + 5);
+    for (size_t b = 0; b < n; b++) {
+        fmt::print(" {:>8}", fmt::format("[{}]", b));
+    }
+    fmt::print("\n");
+    for (size_t a = 0; a < n; a++) {
+        fmt::print("[{}] {:<{}} ", a, method_names[methods[a]], name_width);
+        for (size_t b = 0; b < n; b++) {
+            const long count = agreement.num_disagreements[a * n + b];
+            if (a == b) {
+                fmt::print(" {:>8}", "-");
+            } else {
+                fmt::print(
+                    fmt::fg(
+                        count ? fmt::terminal_color::yellow
+                              : fmt::terminal_color::green),
+                    " {:>8d}", count);
+            }
+        }
+        fmt::print("\n");
+    }
+    for (size_t a = 0; a < n; a++) {
+        for (size_t b = a + 1; b < n; b++) {
+            if (!agreement.first_disagreements[a * n + b].empty()) {
+                fmt::print(
+                    "first disagreement of [{}] and [{}]: {}\n", a, b,
+                    agreement.first_disagreements[a * n + b]);
+            }
+        }
+    }
+    std::cout << std::endl;
+}
+
+/// Write the report to the --output files and compare it with the baseline.
+/// @return The exit status: 1 if --compare found a regression.
+int write_benchmark_report(
+    const CLIArgs& args,
+    const BenchmarkReport& baseline,
+    BenchmarkReport& report)
+{
+    if (args.output_paths.empty() && args.baseline_path.empty()) {
+        return EXIT_SUCCESS;
+    }
+    if (report.fingerprint.empty()) { // else merged from shards
+        report.fingerprint = benchmark_fingerprint(args);
+        report.peak_rss = getPeakRSS();
+    }
+
+    for (const std::string& path : args.output_paths) {
+        try {
+            if (fs::path(path).extension() == ".json") {
+                write_report_json(report, path);
+            } else {
+                write_report_csv(report, path);
+            }
+            std::cout << "wrote " << path << std::endl;
+        } catch (const char* err) {
+            std::cerr << err << ": " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (args.baseline_path.empty()) {
+        return EXIT_SUCCESS;
+    }
+    const std::vector<std::string> regressions
+        = find_regressions(baseline, report, args.regression_threshold);
+    if (regressions.empty()) {
+        fmt::print(
+            fmt::fg(fmt::terminal_color::green),
+            "no regressions compared to {} (threshold {:g}%)",
+            args.baseline_path, 100 * args.regression_threshold);
+        std::cout << std::endl;
+        return EXIT_SUCCESS;
+    }
+    fmt::print(
+        fmt::fg(fmt::terminal_color::red),
+        "{} regression(s) compared to {} (threshold {:g}%):",
+        regressions.size(), args.baseline_path,
+        100 * args.regression_threshold);
+    std::cout << std::endl;
+    for (const std::string& regression : regressions) {
+        fmt::print("  {}\n", regression);
+    }
+    return 1;
+}
+
+/// Merge the reports of --merge, print the merged records, and write and
+/// compare them as those of a run.
+int merge_benchmark_reports(
+    const CLIArgs& args, const BenchmarkReport& baseline)
+{
+    std::vector<BenchmarkReport> shards;
+    BenchmarkReport report;
+    try {
+        for (const std::string& path : args.merge_paths) {
+            shards.push_back(read_report_json(path));
+        }
+        report = merge_reports(shards);
+    } catch (const char* err) {
+        std::cerr << "--merge: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fmt::print(
+        "merged {} reports ({} records)\n", shards.size(),
+        report.records.size());
+    for (const BenchmarkRecord& record : report.records) {
+        fmt::print(
+            "{}: {} queries, {} false positives, {} false negatives, average "
+            "{:.0f}ns, p50 {:.0f}ns, p99 {:.0f}ns\n",
+            record.key(), record.num_queries, record.num_false_positives,
+            record.num_false_negatives, record.average_time,
+            record.latency.p50, record.latency.p99);
+    }
+    return write_benchmark_report(args, baseline, report);
+}
+
+/// Options of the run that change the result or time of a query.
+QueryOptions query_options(const CLIArgs& args)
+{
+    QueryOptions options;
+    options.preprocessing = args.preprocessing;
+    options.minimum_separation = args.minimum_separation;
+    options.tolerance = args.tight_inclusion_tolerance;
+    options.max_iter = args.tight_inclusion_max_iter;
+    return options;
+}
+
+/// Write the slowest queries of a method on a dataset (--dump-slowest) for
+/// --replay and visualization/visualCCD.py.
+void dump_slowest_queries(
+    const CLIArgs& args,
+    const BenchmarkGroup& group,
+    const CCDMethod method,
+    const std::vector<SlowQuery>& slowest)
+{
+    if (slowest.empty()) {
+        return;
+    }
+    const fs::path path = fs::path(args.dump_dir)
+        / fmt::format("slowest-{}-{}-{}.csv", method_names[method],
+                      group.is_simulation_data ? "simulation" : "handcrafted",
+                      group.is_edge_edge ? "edge-edge" : "vertex-face");
+    try {
+        fs::create_directories(args.dump_dir);
+        write_slowest_queries(
+            path.string(), method, group.is_edge_edge, query_options(args),
+            slowest, args.num_slowest);
+    } catch (const char* err) {
+        std::cerr << "--dump-slowest: " << err << ": " << path.string()
+                  << std::endl;
+        return;
+    } catch (const fs::filesystem_error& err) {
+        std::cerr << "--dump-slowest: " << err.what() << std::endl;
+        return;
+    }
+    fmt::print(
+        "wrote the {} slowest queries of {} to {}\n",
+        std::min(slowest.size(), args.num_slowest), method_names[method],
+        path.string());
+}
+
+/// Run each query of a --dump-slowest file (--replay) with its method and
+/// options --replay-repetitions times in a loop, e.g., under a profiler, and
+/// print their times. Refuses to run if the options on the command line
+/// differ from those of the file.
+int replay_slowest_queries(const CLIArgs& cli_args)
+{
+    SlowestQueries file;
+    try {
+        file = read_slowest_queries(cli_args.replay_path);
+    } catch (const char* err) {
+        std::cerr << "--replay: " << err << ": " << cli_args.replay_path
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    CLIArgs args = cli_args;
+    const std::string options = format_query_options(file.options);
+    const std::string cli_options
+        = format_query_options(query_options(cli_args));
+    if (file.has_options && cli_args.has_query_options
+        && options != cli_options) {
+        std::cerr << "--replay: the queries of " << args.replay_path
+                  << " were run with " << options
+                  << ", but the command line has " << cli_options
+                  << " (leave these options out to use those of the file)"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (file.has_options) {
+        args.preprocessing = file.options.preprocessing;
+        args.minimum_separation = file.options.minimum_separation;
+        args.tight_inclusion_tolerance = file.options.tolerance;
+        args.tight_inclusion_max_iter = file.options.max_iter;
+    }
+    if (!is_method_enabled(file.method)) {
+        std::cerr << "CCD method " << method_names[file.method]
+                  << " requested, but it is disabled" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const long num_queries = file.V.rows() / 8;
+
+    fmt::print(
+        "replaying {} {} queries of {} {} times with {}\n", num_queries,
+        file.is_edge_edge ? "edge-edge" : "vertex-face",
+        method_names[file.method], args.num_replays,
+        format_query_options(query_options(args)));
+    std::vector<std::vector<double>> times(num_queries);
+    std::vector<bool> results(num_queries);
+    Eigen::Matrix<double, 8, 3> query, preprocessed;
+    for (int r = 0; r < args.num_replays; r++) {
+        for (long q = 0; q < num_queries; q++) {
+            query = file.V.middleRows<8>(8 * q);
+            double time;
+            results[q] = time_ccd_query(
+                args, file.method, file.is_edge_edge, query, preprocessed,
+                time);
+            times[q].push_back(time);
+        }
+    }
+    print_replayed_queries(times, results, file.expected_results);
+    return EXIT_SUCCESS;
+}
+
+/// Split every task into ranges of up to range_size queries, so threads
+/// share the queries of large files instead of waiting for the thread with
+/// the largest one. Reads every file whose ranges are not in the cache;
+/// tasks of unreadable files are kept whole (and report the error when
+/// they run).
+void split_benchmark_tasks(
+    const size_t range_size,
+    std::map<std::string, std::vector<QueryRange>>& ranges_cache,
+    std::vector<BenchmarkTask>& tasks,
+    std::vector<BenchmarkGroup>& groups)
+{
+    std::vector<BenchmarkTask> split_tasks;
+    for (BenchmarkGroup& group : groups) {
+        const size_t first_task = split_tasks.size();
+        for (size_t i = group.first_task; i < group.end_task; i++) {
+            const BenchmarkTask& task = tasks[i];
+            auto ranges = ranges_cache.find(task.path.string());
+            if (ranges == ranges_cache.end()) {
+                std::vector<QueryRange> file_ranges;
+                try {
+                    file_ranges
+                        = split_query_file(task.path.string(), range_size);
+                } catch (const char*) {
+                    // Kept whole (see above)
+                }
+                ranges
+                    = ranges_cache.insert({ task.path.string(), file_ranges })
+                          .first;
+            }
+
+            if (ranges->second.empty()) {
+                split_tasks.push_back(task);
+                continue;
+            }
+            for (const QueryRange& range : ranges->second) {
+                split_tasks.push_back(task);
+                BenchmarkTask& split_task = split_tasks.back();
+                split_task.num_queries[0] = range.num_queries[0];
+                split_task.num_queries[1] = range.num_queries[1];
+                split_task.start = range.start;
+                split_task.max_queries
+                    = range.num_queries[0] + range.num_queries[1];
+            }
+        }
+        group.first_task = first_task;
+        group.end_task = split_tasks.size();
+    }
+    tasks = std::move(split_tasks);
+}
+
+/// Time every method with each number of threads of --scaling on the same
+/// queries, with the threads pinned to cores. The files are split into
+/// ranges of 4096 queries, so there is work for every thread.
+std::vector<ScalingRecord>
+run_scaling_study(const CLIArgs& args, const std::vector<CCDMethod>& methods)
+{
+    const std::vector<int> cpus = cpu_pinning_order(args.numa_aware);
+    if (cpus.empty()) {
+        std::cerr << "warning: unable to pin threads to CPUs" << std::endl;
+    } else if (args.scaling_threads.back() > int(cpus.size())) {
+        std::cerr << "warning: only " << cpus.size()
+                  << " CPUs are available, so more threads share them"
+                  << std::endl;
+    }
+
+    std::vector<ScalingRecord> records;
+    // Splitting reads every file once, so the first run does not pay for a
+    // cold page cache either.
+    std::map<std::string, std::vector<QueryRange>> ranges_cache;
+    for (CCDMethod method : methods) {
+        std::vector<BenchmarkTask> tasks;
+        std::vector<BenchmarkGroup> groups;
+        plan_benchmark_groups(args, { method }, tasks, groups);
+        split_benchmark_tasks(
+            /*range_size=*/4096, ranges_cache, tasks, groups);
+        if (args.sample_size > 0) {
+            plan_sample(args, tasks, groups);
+        }
+
+        fmt::print(
+            fmt::emphasis::bold | fmt::emphasis::underline, "Scaling of {}\n",
+            method_names[method]);
+        print_scaling_header();
+
+        const size_t base = records.size();
+        for (int num_threads : args.scaling_threads) {
+            // Prefetching threads would share the pinned cores.
+            CLIArgs run_args = args;
+            run_args.num_threads = num_threads;
+            run_args.prefetch = false;
+
+            std::vector<MethodsResults> task_results;
+            ScalingRun run;
+            Timer timer;
+            timer.start();
+            run_benchmark_tasks(
+                run_args, tasks, groups, task_results, cpus,
+                &run.thread_times);
+            timer.stop();
+            run.wall_time = timer.getElapsedTimeInSec();
+            for (const MethodsResults& task : task_results) {
+                run.num_queries += task.methods[0].num_queries;
+                run.total_time += task.methods[0].total_time;
+            }
+
+            records.push_back(make_scaling_record(
+                method_names[method], num_threads, run,
+                records.size() > base ? &records[base] : nullptr));
+            print_scaling_record(records.back());
+        }
+        std::cout << std::endl;
+    }
+    return records;
+}
+
+/// Time the minimum separation methods on every point of the --sweep-* grid
+/// (on all datasets together) and print each point, marking the Pareto
+/// frontier of average time, false positives, false negatives, and maximum
+/// error of the time of impact. The parameters only change these methods, so
+/// the others are skipped.
+void run_parameter_sweep(
+    const CLIArgs& args, const std::vector<CCDMethod>& methods)
+{
+    // An axis without values keeps the value of the run.
+    const std::vector<double> tolerances = args.sweep_tolerances.empty()
+        ? std::vector<double> { args.tight_inclusion_tolerance }
+        : args.sweep_tolerances;
+    const std::vector<long> max_iters = args.sweep_max_iters.empty()
+        ? std::vector<long> { args.tight_inclusion_max_iter }
+        : args.sweep_max_iters;
+    const std::vector<double> minimum_separations
+        = args.sweep_minimum_separations.empty()
+        ? std::vector<double> { args.minimum_separation }
+        : args.sweep_minimum_separations;
+
+    for (CCDMethod method : methods) {
+        if (!is_minimum_separation_method(method)) {
+            fmt::print(
+                "skipping {}: the sweep parameters do not change it\n\n",
+                method_names[method]);
+            continue;
+        }
+        std::vector<BenchmarkTask> tasks;
+        std::vector<BenchmarkGroup> groups;
+        plan_benchmark_groups(args, { method }, tasks, groups);
+        if (args.sample_size > 0) {
+            plan_sample(args, tasks, groups);
+        }
+
+        fmt::print(
+            fmt::emphasis::bold | fmt::emphasis::underline, "Sweep of {}\n",
+            method_names[method]);
+        std::vector<SweepPoint> points;
+        for (double minimum_separation : minimum_separations) {
+            std::vector<double> reference_tois;
+            for (const std::pair<double, long>& setting :
+                 sweep_settings(tolerances, max_iters)) {
+                CLIArgs run_args = args;
+                run_args.tight_inclusion_tolerance = setting.first;
+                run_args.tight_inclusion_max_iter = setting.second;
+                run_args.minimum_separation = minimum_separation;
+
+                std::vector<MethodsResults> task_results;
+                run_benchmark_tasks(run_args, tasks, groups, task_results);
+                BenchmarkResults results;
+                for (const MethodsResults& task : task_results) {
+                    results.merge(task.methods[0]);
+                }
+
+                SweepPoint point;
+                point.tolerance = setting.first;
+                point.max_iter = setting.second;
+                point.minimum_separation = minimum_separation;
+                point.num_queries = results.num_queries;
+                point.average_time
+                    = 1e3 * results.total_time / results.num_queries;
+                point.p50 = results.latency.percentile(0.5);
+                point.p99 = results.latency.percentile(0.99);
+                point.num_false_positives = results.num_false_positives;
+                point.num_false_negatives = results.num_false_negatives;
+                // The queries run in the same order at every point.
+                if (reference_tois.empty()) {
+                    reference_tois = std::move(results.tois);
+                } else {
+                    measure_toi_error(results.tois, reference_tois, point);
+                }
+                points.push_back(point);
+            }
+        }
+        print_sweep(points);
+        std::cout << std::endl;
+    }
+}
+
+/// @return The exit status: 1 if --compare found a regression.
+int run_all_methods(const CLIArgs& args)
+{
+    // Read the baseline first to fail before running anything.
+    BenchmarkReport baseline;
+    if (!args.baseline_path.empty()) {
+        try {
+            baseline = read_report_json(args.baseline_path);
+        } catch (const char* err) {
+            std::cerr << "--compare: " << err << ": " << args.baseline_path
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!args.merge_paths.empty()) {
+        return merge_benchmark_reports(args, baseline);
+    }
+
+    if (args.count_allocations) {
+        start_counting_allocations();
+    }
+    timer_overhead = measure_timer_overhead();
+    fmt::print(
+        "timer overhead: {:.0f}ns (subtracted from every query)\n\n",
+        timer_overhead);
+
+    if (!args.replay_path.empty()) {
+        return replay_slowest_queries(args);
+    }
+
+    std::vector<CCDMethod> enabled_methods;
+    for (CCDMethod method : args.methods) {
+        if (is_method_enabled(method)) {
+            enabled_methods.push_back(method);
+        }
+    }
+
+    if (args.is_sweep()) {
+        run_parameter_sweep(args, enabled_methods);
+        return EXIT_SUCCESS;
+    }
+
+    if (!args.scaling_threads.empty()) {
+        BenchmarkReport report;
+        report.scaling = run_scaling_study(args, enabled_methods);
+        return write_benchmark_report(args, baseline, report);
+    }
+
+    // A group per method and dataset, or with --single-pass a group per
+    // dataset that runs every method on each query as it is loaded.
+    std::vector<std::vector<CCDMethod>> method_sets;
+    if (args.single_pass) {
+        method_sets.push_back(enabled_methods);
+    } else {
+        for (CCDMethod method : enabled_methods) {
+            method_sets.push_back({ method });
+        }
+    }
+
+    // Plan every (methods, dataset, file) up front, so the files can be run
+    // in any order and the results still be merged in this order.
+    std::vector<BenchmarkTask> tasks;
+    std::vector<BenchmarkGroup> groups;
+    for (const std::vector<CCDMethod>& methods : method_sets) {
+        plan_benchmark_groups(args, methods, tasks, groups);
+    }
+    if (args.sample_size > 0) {
+        plan_sample(args, tasks, groups);
+    }
+    // After sampling, so the shards run the queries of a single run.
+    if (args.num_shards > 1) {
+        select_shard(args, tasks, groups);
+    }
+
+    const int num_datasets
+        = (int(args.run_handcrafted_dataset) + int(args.run_simulation_dataset))
+        * (int(args.run_vf_dataset) + int(args.run_ee_dataset));
+
+    std::vector<MethodsResults> task_results;
+    run_benchmark_tasks(args, tasks, groups, task_results);
+
+    const auto merge_group = [&](const BenchmarkGroup& group) {
+        MethodsResults results(group.methods.size());
+        for (size_t i = group.first_task; i < group.end_task; i++) {
+            results.merge(task_results[i]);
+        }
+        return results;
+    };
+    const auto print_dataset_header = [&](const BenchmarkGroup& group) {
+        // Each dataset starts with its vertex-face queries if enabled.
+        if (!group.is_edge_edge || !args.run_vf_dataset) {
+            fmt::print(
+                fmt::emphasis::bold, "Running {} dataset:\n",
+                group.is_simulation_data ? "simulation" : "handcrafted");
+        }
+        std::cout << (group.is_edge_edge ? "Edge-Edge:" : "Vertex-Face:")
+                  << std::endl;
+        if (group.first_task == group.end_task) {
+            std::cout << "No matching query files in " << args.data_dir
+                      << std::endl;
+        }
+    };
+
+    if (args.single_pass) {
+        for (CCDMethod method : args.methods) {
+            if (!is_method_enabled(method)) {
+                std::cerr << "CCD method " << method_names[method]
+                          << " requested, but it is disabled" << std::endl;
+            }
+        }
+        for (const BenchmarkGroup& group : groups) {
+            print_dataset_header(group);
+            const MethodsResults results = merge_group(group);
+            const auto scenes = merge_scenes(group, tasks, task_results);
+            for (size_t k = 0; k < group.methods.size(); k++) {
+                fmt::print(
+                    fmt::emphasis::underline, "{}\n",
+                    method_names[group.methods[k]]);
+                print_benchmark_results(args, results.methods[k]);
+                print_scene_latencies(scenes, k);
+                print_sample_estimates(args, group, tasks, task_results, k);
+            }
+            if (group.methods.size() > 1) {
+                print_agreement_matrix(group.methods, results.agreement);
+            }
+        }
+    } else {
+        auto group = groups.begin();
+        for (CCDMethod method : args.methods) {
+            if (!is_method_enabled(method)) {
+                std::cerr << "CCD method " << method_names[method]
+                          << " requested, but it is disabled" << std::endl;
+                std::cout << std::endl;
+                continue;
+            }
+            fmt::print(
+                fmt::emphasis::bold | fmt::emphasis::underline,
                 "Benchmarking {}\n", method_names[method]);
-            run_one_method_over_all_data(args, method);
+            for (int i = 0; i < num_datasets; i++, ++group) {
+                print_dataset_header(*group);
+                print_benchmark_results(args, merge_group(*group).methods[0]);
+                print_scene_latencies(
+                    merge_scenes(*group, tasks, task_results), 0);
+                print_sample_estimates(args, *group, tasks, task_results, 0);
+            }
             fmt::print("finished {}\n", method_names[method]);
-        } else {
-            std::cerr << "CCD method " << method_names[method]
-                      << " requested, but it is disabled" << std::endl;
+            std::cout << std::endl;
+        }
+    }
+
+    if (args.num_slowest > 0) {
+        for (const BenchmarkGroup& group : groups) {
+            const MethodsResults results = merge_group(group);
+            for (size_t k = 0; k < group.methods.size(); k++) {
+                dump_slowest_queries(
+                    args, group, group.methods[k], results.methods[k].slowest);
+            }
         }
         std::cout << std::endl;
     }
+
+    // A record per method and dataset with the scene "all", and one per
+    // scene of it
+    BenchmarkReport report;
+    for (const BenchmarkGroup& group : groups) {
+        const MethodsResults results = merge_group(group);
+        const auto scenes = merge_scenes(group, tasks, task_results);
+        for (size_t k = 0; k < group.methods.size(); k++) {
+            report.records.push_back(make_benchmark_record(
+                group, group.methods[k], "all", results.methods[k]));
+            for (const auto& scene : scenes) {
+                report.records.push_back(make_benchmark_record(
+                    group, group.methods[k], scene.first,
+                    scene.second.methods[k]));
+            }
+        }
+    }
+
+    return write_benchmark_report(args, baseline, report);
 }
 
-int main(int argc, char* argv[]) { run_all_methods(CLIArgs(argc, argv)); }
+int main(int argc, char* argv[])
+{
+    return run_all_methods(CLIArgs(argc, argv));
+}
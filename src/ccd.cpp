@@ -2,6 +2,7 @@
 #include "ccd.hpp"
 
 #include <iostream>
+#include <limits>
 
 // Etienne Vouga's CCD using a root finder in floating points
 #if CCD_WRAPPER_WITH_FPRF
@@ -48,11 +49,28 @@
 #if CCD_WRAPPER_WITH_TIGHT_INCLUSION
 #include <tight_inclusion/inclusion_ccd.hpp>
 #endif
+// Root parity of Brochu et al. [2012] using floating-point expansions
+#if CCD_WRAPPER_WITH_ERP
+#include <root_parity/expansion_root_parity.hpp>
+#endif
+#if CCD_WRAPPER_WITH_FXRP
+#include <root_parity/fixed_point_root_parity.hpp>
+#endif
+// Certified double filter tried before the exact root parity methods
+#if CCD_WRAPPER_WITH_RP_FILTER
+#include <root_parity/filtered_root_parity.hpp>
+#endif
+
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+#include <query_recording.hpp>
+#endif
 
 namespace ccd {
 
-// Detect collisions between a vertex and a triangular face.
-bool vertexFaceCCD(
+namespace {
+
+// vertexFaceCCD, with the time of impact of the methods that compute one
+bool vertex_face_ccd(
     const Eigen::Vector3d& vertex_start,
     const Eigen::Vector3d& face_vertex0_start,
     const Eigen::Vector3d& face_vertex1_start,
@@ -64,9 +82,9 @@ bool vertexFaceCCD(
     const CCDMethod method,
     const double tolerance,
     const long max_iter,
-    const std::array<double, 3>& err)
+    const std::array<double, 3>& err,
+    double& toi)
 {
-    double toi; // Computed by some methods but never returned
     try {
         switch (method) {
         case CCDMethod::FLOATING_POINT_ROOT_FINDER:
@@ -96,7 +114,7 @@ bool vertexFaceCCD(
                 // Triangle at t = 1
                 face_vertex0_end, face_vertex1_end, face_vertex2_end,
                 /*minimum_distance=*/DEFAULT_MIN_DISTANCE, method, tolerance,
-                max_iter, err);
+                max_iter, err, &toi);
 #else
             throw "CCD method is not enabled";
 #endif
@@ -122,6 +140,17 @@ bool vertexFaceCCD(
 #endif
         case CCDMethod::RATIONAL_ROOT_PARITY:
 #if CCD_WRAPPER_WITH_RRP
+#if CCD_WRAPPER_WITH_RP_FILTER
+            {
+                bool filtered_result;
+                if (root_parity::vertexFaceCCD_filtered(
+                        vertex_start, face_vertex0_start, face_vertex1_start,
+                        face_vertex2_start, vertex_end, face_vertex0_end,
+                        face_vertex1_end, face_vertex2_end, filtered_result)) {
+                    return filtered_result;
+                }
+            }
+#endif
             return eccd::vertexFaceCCD(
                 // Point at t=0
                 vertex_start,
@@ -173,7 +202,7 @@ bool vertexFaceCCD(
                 vertex_end,
                 // Triangle at t = 1
                 face_vertex0_end, face_vertex1_end, face_vertex2_end,
-                /*minimum_distance=*/0, method, tolerance, max_iter, err);
+                /*minimum_distance=*/0, method, tolerance, max_iter, err, &toi);
         case CCDMethod::BSC:
 #if CCD_WRAPPER_WITH_BSC
             return bsc::Intersect_VF_robust(
@@ -268,25 +297,122 @@ bool vertexFaceCCD(
 #else
             throw "CCD method is not enabled";
 #endif
+        case CCDMethod::EXPANSION_ROOT_PARITY:
+#if CCD_WRAPPER_WITH_ERP
+#if CCD_WRAPPER_WITH_RP_FILTER
+            {
+                bool filtered_result;
+                if (root_parity::vertexFaceCCD_filtered(
+                        vertex_start, face_vertex0_start, face_vertex1_start,
+                        face_vertex2_start, vertex_end, face_vertex0_end,
+                        face_vertex1_end, face_vertex2_end, filtered_result)) {
+                    return filtered_result;
+                }
+            }
+#endif
+            return root_parity::vertexFaceCCD_expansion(
+                // Point at t=0
+                vertex_start,
+                // Triangle at t = 0
+                face_vertex0_start, face_vertex1_start, face_vertex2_start,
+                // Point at t=1
+                vertex_end,
+                // Triangle at t = 1
+                face_vertex0_end, face_vertex1_end, face_vertex2_end);
+#else
+            throw "CCD method is not enabled";
+#endif
+        case CCDMethod::FIXED_POINT_ROOT_PARITY:
+#if CCD_WRAPPER_WITH_FXRP
+            return root_parity::vertexFaceCCD_fixed_point(
+                // Point at t=0
+                vertex_start,
+                // Triangle at t = 0
+                face_vertex0_start, face_vertex1_start, face_vertex2_start,
+                // Point at t=1
+                vertex_end,
+                // Triangle at t = 1
+                face_vertex0_end, face_vertex1_end, face_vertex2_end);
+#else
+            throw "CCD method is not enabled";
+#endif
 
         default:
             throw "Invalid CCDMethod";
         }
     } catch (const char* err) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Vertex-face CCD failed because \"" << err << "\" for "
                   << method_names[method] << std::endl;
         return true;
     } catch (...) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Vertex-face CCD failed for unknown reason when using "
                   << method_names[method] << std::endl;
         return true;
     }
 }
 
-// Detect collisions between two edges as they move.
-bool edgeEdgeCCD(
+} // namespace
+
+// Detect collisions between a vertex and a triangular face.
+bool vertexFaceCCD(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end,
+    const CCDMethod method,
+    const double tolerance,
+    const long max_iter,
+    const std::array<double, 3>& err,
+    double* const toi)
+{
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+    if (should_record_query()) {
+        const Eigen::Vector3d* const points[8] = {
+            &vertex_start, &face_vertex0_start, &face_vertex1_start,
+            &face_vertex2_start, &vertex_end, &face_vertex0_end,
+            &face_vertex1_end, &face_vertex2_end
+        };
+        return record_query(
+            points, /*is_edge_edge=*/false, method, /*is_msccd=*/false,
+            /*min_distance=*/0, tolerance, max_iter, [&]() {
+                return vertexFaceCCD(
+                    vertex_start, face_vertex0_start, face_vertex1_start,
+                    face_vertex2_start, vertex_end, face_vertex0_end,
+                    face_vertex1_end, face_vertex2_end, method, tolerance,
+                    max_iter, err, toi);
+            });
+    }
+#endif
+
+    double t = std::numeric_limits<double>::quiet_NaN();
+    const bool hit = vertex_face_ccd(
+        vertex_start, face_vertex0_start, face_vertex1_start,
+        face_vertex2_start, vertex_end, face_vertex0_end, face_vertex1_end,
+        face_vertex2_end, method, tolerance, max_iter, err, t);
+    if (toi != nullptr) {
+        *toi = hit ? t : std::numeric_limits<double>::quiet_NaN();
+    }
+    return hit;
+}
+
+namespace {
+
+// edgeEdgeCCD, with the time of impact of the methods that compute one
+bool edge_edge_ccd(
     const Eigen::Vector3d& edge0_vertex0_start,
     const Eigen::Vector3d& edge0_vertex1_start,
     const Eigen::Vector3d& edge1_vertex0_start,
@@ -298,9 +424,9 @@ bool edgeEdgeCCD(
     const CCDMethod method,
     const double tolerance,
     const long max_iter,
-    const std::array<double, 3>& err)
+    const std::array<double, 3>& err,
+    double& toi)
 {
-    double toi; // Computed by some methods but never returned
     try {
         switch (method) {
         case CCDMethod::FLOATING_POINT_ROOT_FINDER:
@@ -330,7 +456,7 @@ bool edgeEdgeCCD(
                 // Edge 2 at t=1
                 edge1_vertex0_end, edge1_vertex1_end,
                 /*minimum_distance=*/DEFAULT_MIN_DISTANCE, method, tolerance,
-                max_iter, err);
+                max_iter, err, &toi);
 #else
             throw "CCD method is not enabled";
 #endif
@@ -356,6 +482,18 @@ bool edgeEdgeCCD(
 #endif
         case CCDMethod::RATIONAL_ROOT_PARITY:
 #if CCD_WRAPPER_WITH_RRP
+#if CCD_WRAPPER_WITH_RP_FILTER
+            {
+                bool filtered_result;
+                if (root_parity::edgeEdgeCCD_filtered(
+                        edge0_vertex0_start, edge0_vertex1_start,
+                        edge1_vertex0_start, edge1_vertex1_start,
+                        edge0_vertex0_end, edge0_vertex1_end, edge1_vertex0_end,
+                        edge1_vertex1_end, filtered_result)) {
+                    return filtered_result;
+                }
+            }
+#endif
             return eccd::edgeEdgeCCD(
                 // Edge 1 at t=0
                 edge0_vertex0_start, edge0_vertex1_start,
@@ -407,7 +545,7 @@ bool edgeEdgeCCD(
                 edge0_vertex0_end, edge0_vertex1_end,
                 // Edge 2 at t=1
                 edge1_vertex0_end, edge1_vertex1_end,
-                /*minimum_distance=*/0, method, tolerance, max_iter, err);
+                /*minimum_distance=*/0, method, tolerance, max_iter, err, &toi);
         case CCDMethod::BSC:
 #if CCD_WRAPPER_WITH_BSC
             return bsc::Intersect_EE_robust(
@@ -504,25 +642,124 @@ bool edgeEdgeCCD(
 #else
             throw "CCD method is not enabled";
 #endif
+        case CCDMethod::EXPANSION_ROOT_PARITY:
+#if CCD_WRAPPER_WITH_ERP
+#if CCD_WRAPPER_WITH_RP_FILTER
+            {
+                bool filtered_result;
+                if (root_parity::edgeEdgeCCD_filtered(
+                        edge0_vertex0_start, edge0_vertex1_start,
+                        edge1_vertex0_start, edge1_vertex1_start,
+                        edge0_vertex0_end, edge0_vertex1_end, edge1_vertex0_end,
+                        edge1_vertex1_end, filtered_result)) {
+                    return filtered_result;
+                }
+            }
+#endif
+            return root_parity::edgeEdgeCCD_expansion(
+                // Edge 1 at t=0
+                edge0_vertex0_start, edge0_vertex1_start,
+                // Edge 2 at t=0
+                edge1_vertex0_start, edge1_vertex1_start,
+                // Edge 1 at t=1
+                edge0_vertex0_end, edge0_vertex1_end,
+                // Edge 2 at t=1
+                edge1_vertex0_end, edge1_vertex1_end);
+#else
+            throw "CCD method is not enabled";
+#endif
+        case CCDMethod::FIXED_POINT_ROOT_PARITY:
+#if CCD_WRAPPER_WITH_FXRP
+            return root_parity::edgeEdgeCCD_fixed_point(
+                // Edge 1 at t=0
+                edge0_vertex0_start, edge0_vertex1_start,
+                // Edge 2 at t=0
+                edge1_vertex0_start, edge1_vertex1_start,
+                // Edge 1 at t=1
+                edge0_vertex0_end, edge0_vertex1_end,
+                // Edge 2 at t=1
+                edge1_vertex0_end, edge1_vertex1_end);
+#else
+            throw "CCD method is not enabled";
+#endif
 
         default:
             throw "Invalid CCDMethod";
         }
     } catch (const char* err) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Edge-edge CCD failed because \"" << err << "\" for "
                   << method_names[method] << std::endl;
         return true;
     } catch (...) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Edge-edge CCD failed for unknown reason when using "
                   << method_names[method] << std::endl;
         return true;
     }
 }
 
-// Detect collisions between a vertex and a triangular face.
-bool vertexFaceMSCCD(
+} // namespace
+
+// Detect collisions between two edges as they move.
+bool edgeEdgeCCD(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end,
+    const CCDMethod method,
+    const double tolerance,
+    const long max_iter,
+    const std::array<double, 3>& err,
+    double* const toi)
+{
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+    if (should_record_query()) {
+        const Eigen::Vector3d* const points[8] = {
+            &edge0_vertex0_start, &edge0_vertex1_start, &edge1_vertex0_start,
+            &edge1_vertex1_start, &edge0_vertex0_end, &edge0_vertex1_end,
+            &edge1_vertex0_end, &edge1_vertex1_end
+        };
+        return record_query(
+            points, /*is_edge_edge=*/true, method, /*is_msccd=*/false,
+            /*min_distance=*/0, tolerance, max_iter, [&]() {
+                return edgeEdgeCCD(
+                    edge0_vertex0_start, edge0_vertex1_start,
+                    edge1_vertex0_start, edge1_vertex1_start, edge0_vertex0_end,
+                    edge0_vertex1_end, edge1_vertex0_end, edge1_vertex1_end,
+                    method, tolerance, max_iter, err, toi);
+            });
+    }
+#endif
+
+    double t = std::numeric_limits<double>::quiet_NaN();
+    const bool hit = edge_edge_ccd(
+        edge0_vertex0_start, edge0_vertex1_start, edge1_vertex0_start,
+        edge1_vertex1_start, edge0_vertex0_end, edge0_vertex1_end,
+        edge1_vertex0_end, edge1_vertex1_end, method, tolerance, max_iter, err,
+        t);
+    if (toi != nullptr) {
+        *toi = hit ? t : std::numeric_limits<double>::quiet_NaN();
+    }
+    return hit;
+}
+
+namespace {
+
+// vertexFaceMSCCD, with the time of impact of the methods that compute one
+bool vertex_face_msccd(
     const Eigen::Vector3d& vertex_start,
     const Eigen::Vector3d& face_vertex0_start,
     const Eigen::Vector3d& face_vertex1_start,
@@ -535,9 +772,9 @@ bool vertexFaceMSCCD(
     const CCDMethod method,
     const double tolerance,
     const long max_iter,
-    const std::array<double, 3>& err)
+    const std::array<double, 3>& err,
+    double& toi)
 {
-    double toi; // Computed by some methods but never returned
     try {
         switch (method) {
         case CCDMethod::MIN_SEPARATION_ROOT_FINDER:
@@ -597,19 +834,78 @@ bool vertexFaceMSCCD(
         }
     } catch (const char* err) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Vertex-face CCD failed because \"" << err << "\" for "
                   << method_names[method] << std::endl;
         return true;
     } catch (...) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Vertex-face CCD failed for unknown reason when using "
                   << method_names[method] << std::endl;
         return true;
     }
 }
 
-// Detect collisions between two edges as they move.
-bool edgeEdgeMSCCD(
+} // namespace
+
+// Detect collisions between a vertex and a triangular face.
+bool vertexFaceMSCCD(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end,
+    const double min_distance,
+    const CCDMethod method,
+    const double tolerance,
+    const long max_iter,
+    const std::array<double, 3>& err,
+    double* const toi)
+{
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+    if (should_record_query()) {
+        const Eigen::Vector3d* const points[8] = {
+            &vertex_start, &face_vertex0_start, &face_vertex1_start,
+            &face_vertex2_start, &vertex_end, &face_vertex0_end,
+            &face_vertex1_end, &face_vertex2_end
+        };
+        return record_query(
+            points, /*is_edge_edge=*/false, method, /*is_msccd=*/true,
+            min_distance, tolerance, max_iter, [&]() {
+                return vertexFaceMSCCD(
+                    vertex_start, face_vertex0_start, face_vertex1_start,
+                    face_vertex2_start, vertex_end, face_vertex0_end,
+                    face_vertex1_end, face_vertex2_end, min_distance, method,
+                    tolerance, max_iter, err, toi);
+            });
+    }
+#endif
+
+    double t = std::numeric_limits<double>::quiet_NaN();
+    const bool hit = vertex_face_msccd(
+        vertex_start, face_vertex0_start, face_vertex1_start,
+        face_vertex2_start, vertex_end, face_vertex0_end, face_vertex1_end,
+        face_vertex2_end, min_distance, method, tolerance, max_iter, err, t);
+    if (toi != nullptr) {
+        *toi = hit ? t : std::numeric_limits<double>::quiet_NaN();
+    }
+    return hit;
+}
+
+namespace {
+
+// edgeEdgeMSCCD, with the time of impact of the methods that compute one
+bool edge_edge_msccd(
     const Eigen::Vector3d& edge0_vertex0_start,
     const Eigen::Vector3d& edge0_vertex1_start,
     const Eigen::Vector3d& edge1_vertex0_start,
@@ -622,9 +918,9 @@ bool edgeEdgeMSCCD(
     const CCDMethod method,
     const double tolerance,
     const long max_iter,
-    const std::array<double, 3>& err)
+    const std::array<double, 3>& err,
+    double& toi)
 {
-    double toi; // Computed by some methods but never returned
     try {
         switch (method) {
         case CCDMethod::MIN_SEPARATION_ROOT_FINDER:
@@ -683,15 +979,73 @@ bool edgeEdgeMSCCD(
         }
     } catch (const char* err) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Edge-edge CCD failed because \"" << err << "\" for "
                   << method_names[method] << std::endl;
         return true;
     } catch (...) {
         // Conservative answer upon failure.
+        toi = std::numeric_limits<double>::quiet_NaN();
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+        note_query_fallback();
+#endif
         std::cerr << "Edge-edge CCD failed for unknown reason when using "
                   << method_names[method] << std::endl;
         return true;
     }
 }
 
+} // namespace
+
+// Detect collisions between two edges as they move.
+bool edgeEdgeMSCCD(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end,
+    const double min_distance,
+    const CCDMethod method,
+    const double tolerance,
+    const long max_iter,
+    const std::array<double, 3>& err,
+    double* const toi)
+{
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+    if (should_record_query()) {
+        const Eigen::Vector3d* const points[8] = {
+            &edge0_vertex0_start, &edge0_vertex1_start, &edge1_vertex0_start,
+            &edge1_vertex1_start, &edge0_vertex0_end, &edge0_vertex1_end,
+            &edge1_vertex0_end, &edge1_vertex1_end
+        };
+        return record_query(
+            points, /*is_edge_edge=*/true, method, /*is_msccd=*/true,
+            min_distance, tolerance, max_iter, [&]() {
+                return edgeEdgeMSCCD(
+                    edge0_vertex0_start, edge0_vertex1_start,
+                    edge1_vertex0_start, edge1_vertex1_start, edge0_vertex0_end,
+                    edge0_vertex1_end, edge1_vertex0_end, edge1_vertex1_end,
+                    min_distance, method, tolerance, max_iter, err, toi);
+            });
+    }
+#endif
+
+    double t = std::numeric_limits<double>::quiet_NaN();
+    const bool hit = edge_edge_msccd(
+        edge0_vertex0_start, edge0_vertex1_start, edge1_vertex0_start,
+        edge1_vertex1_start, edge0_vertex0_end, edge0_vertex1_end,
+        edge1_vertex0_end, edge1_vertex1_end, min_distance, method, tolerance,
+        max_iter, err, t);
+    if (toi != nullptr) {
+        *toi = hit ? t : std::numeric_limits<double>::quiet_NaN();
+    }
+    return hit;
+}
+
 } // namespace ccd
@@ -34,6 +34,10 @@ enum CCDMethod {
     MULTIVARIATE_INTERVAL_ROOT_FINDER,
     /// Custom inclusion based CCD of [Wang et al. 2020]
     TIGHT_INCLUSION,
+    /// Root parity of [Brochu et al. 2012] using floating-point expansions
+    EXPANSION_ROOT_PARITY,
+    /// Root parity of [Brochu et al. 2012] using fixed-point integers
+    FIXED_POINT_ROOT_PARITY,
     /// WARNING: Not a method! Counts the number of methods.
     NUM_CCD_METHODS
 };
@@ -51,6 +55,8 @@ static const char* method_names[CCDMethod::NUM_CCD_METHODS] = {
     "UnivariateIntervalRootFinder",
     "MultivariateIntervalRootFinder",
     "TightInclusion",
+    "ExpansionRootParity",
+    "FixedPointRootParity",
 };
 
 /// Minimum separation distance used when looking for 0 distance collisions.
@@ -77,6 +83,11 @@ static const double DEFAULT_MIN_DISTANCE = 1e-8;
  * @param[in]  face_vertex2_end    End position of the third vertex of the
  *                                 face.
  * @param[in]  method              Method of exact CCD.
+ * @param[out] toi                 If not null, set to the time of impact of the
+ *                                 collision found by the method, for those that
+ *                                 compute one (FloatingPointRootFinder,
+ *                                 MinSeparationRootFinder, the interval
+ *                                 methods, and TightInclusion), or NaN.
  *
  * @returns  True if the vertex and face collide.
  */
@@ -92,7 +103,8 @@ bool vertexFaceCCD(
     const CCDMethod method,
     const double tolerance = 1e-6,
     const long max_iter = 1e6,
-    const std::array<double, 3>& err = { { -1, 0, 0 } });
+    const std::array<double, 3>& err = { { -1, 0, 0 } },
+    double* toi = nullptr);
 
 /**
  * @brief Detect collisions between two edges as they move.
@@ -117,6 +129,11 @@ bool vertexFaceCCD(
  * @param[in]  edge1_vertex1_end    End position of the second edge's second
  *                                  vertex.
  * @param[in]  method               Method of exact CCD.
+ * @param[out] toi                  If not null, set to the time of impact of
+ *                                  the collision found by the method, for those
+ *                                  that compute one (FloatingPointRootFinder,
+ *                                  MinSeparationRootFinder, the interval
+ *                                  methods, and TightInclusion), or NaN.
  *
  * @returns True if the edges collide.
  */
@@ -132,7 +149,8 @@ bool edgeEdgeCCD(
     const CCDMethod method,
     const double tolerance = 1e-6,
     const long max_iter = 1e6,
-    const std::array<double, 3>& err = { { -1, 0, 0 } });
+    const std::array<double, 3>& err = { { -1, 0, 0 } },
+    double* toi = nullptr);
 
 /**
  * @brief Detect proximity collisions between a vertex and a triangular face.
@@ -155,6 +173,11 @@ bool edgeEdgeCCD(
  * @param[in]  face_vertex2_end    End position of the third vertex of the
  *                                 face.
  * @param[in]  method              Method of minimum separation CCD.
+ * @param[out] toi                 If not null, set to the time of impact of the
+ *                                 collision found by the method, for those that
+ *                                 compute one (FloatingPointRootFinder,
+ *                                 MinSeparationRootFinder, the interval
+ *                                 methods, and TightInclusion), or NaN.
  *
  * @returns  True if the vertex and face collide.
  */
@@ -171,7 +194,8 @@ bool vertexFaceMSCCD(
     const CCDMethod method,
     const double tolerance = 1e-6,
     const long max_iter = 1e6,
-    const std::array<double, 3>& err = { { -1, 0, 0 } });
+    const std::array<double, 3>& err = { { -1, 0, 0 } },
+    double* toi = nullptr);
 
 /**
  * @brief Detect proximity collisions between two edges as they move.
@@ -196,6 +220,11 @@ bool vertexFaceMSCCD(
  * @param[in]  edge1_vertex1_end    End position of the second edge's second
  *                                  vertex.
  * @param[in]  method               Method of minimum separation CCD.
+ * @param[out] toi                  If not null, set to the time of impact of
+ *                                  the collision found by the method, for those
+ *                                  that compute one (FloatingPointRootFinder,
+ *                                  MinSeparationRootFinder, the interval
+ *                                  methods, and TightInclusion), or NaN.
  *
  * @returns True if the edges collide.
  */
@@ -212,7 +241,8 @@ bool edgeEdgeMSCCD(
     const CCDMethod method,
     const double tolerance = 1e-6,
     const long max_iter = 1e6,
-    const std::array<double, 3>& err = { { -1, 0, 0 } });
+    const std::array<double, 3>& err = { { -1, 0, 0 } },
+    double* toi = nullptr);
 
 inline bool is_minimum_separation_method(const CCDMethod& method)
 {
@@ -241,6 +271,21 @@ inline bool is_conservative_method(const CCDMethod& method)
     }
 }
 
+/// Is the answer of the method unchanged when a query is scaled by a power of
+/// two? True for the exact methods, whose predicates are homogeneous.
+inline bool is_scale_invariant_method(const CCDMethod& method)
+{
+    switch (method) {
+    case CCDMethod::RATIONAL_ROOT_PARITY:
+    case CCDMethod::RATIONAL_FIXED_ROOT_PARITY:
+    case CCDMethod::EXPANSION_ROOT_PARITY:
+    case CCDMethod::FIXED_POINT_ROOT_PARITY:
+        return true;
+    default:
+        return false;
+    }
+}
+
 inline bool is_time_of_impact_computed(const CCDMethod& method)
 {
     switch (method) {
@@ -292,6 +337,12 @@ inline bool is_method_enabled(const CCDMethod& method)
     case TIGHT_INCLUSION:
         return CCD_WRAPPER_WITH_TIGHT_INCLUSION;
 
+    case EXPANSION_ROOT_PARITY:
+        return CCD_WRAPPER_WITH_ERP;
+
+    case FIXED_POINT_ROOT_PARITY:
+        return CCD_WRAPPER_WITH_FXRP;
+
     default:
         return false;
     }
@@ -0,0 +1,187 @@
+// Convert rational CSV queries and query recordings to the binary query format
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <Eigen/Core>
+#include <fmt/format.h>
+#include <ghc/fs_std.hpp> // filesystem
+#include <gmp.h>
+
+#include <ccd.hpp>
+#include <query_recording.hpp>
+#include <utils/binary_queries.hpp>
+#include <utils/read_rational_csv.hpp>
+
+using namespace ccd;
+
+/// Check that every coordinate in the CSV equals its double in V exactly.
+bool has_exact_coordinates(const fs::path& csv_path, const Eigen::MatrixXd& V)
+{
+    std::ifstream file(csv_path.string());
+    mpq_t rational, converted;
+    mpq_init(rational);
+    mpq_init(converted);
+
+    bool is_exact = true;
+    int row = 0;
+    std::string line;
+    while (is_exact && std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream ss(line);
+        for (int i = 0; i < 3 && is_exact; i++) {
+            std::string num, denom;
+            std::getline(ss, num, ',');
+            std::getline(ss, denom, ',');
+            mpz_set_str(mpq_numref(rational), num.c_str(), 10);
+            mpz_set_str(mpq_denref(rational), denom.c_str(), 10);
+            mpq_canonicalize(rational);
+            mpq_set_d(converted, V(row, i));
+            is_exact = mpq_equal(rational, converted) != 0;
+        }
+        row++;
+    }
+
+    mpq_clear(rational);
+    mpq_clear(converted);
+    return is_exact && row == V.rows();
+}
+
+void convert(const fs::path& csv_path)
+{
+    std::vector<bool> results;
+    const Eigen::MatrixXd V = read_rational_csv(
+        csv_path.string(), results,
+        std::max(int(std::thread::hardware_concurrency()), 1));
+
+    uint32_t flags = 0;
+    if (has_exact_coordinates(csv_path, V)) {
+        flags |= EXACT_COORDINATES;
+    }
+
+    fs::path binary_path = csv_path;
+    binary_path.replace_extension(BINARY_QUERIES_EXTENSION);
+    write_binary_queries(binary_path.string(), V, results, flags);
+
+    fmt::print(
+        "{} -> {} ({:d} queries, {} coordinates)\n", csv_path.string(),
+        binary_path.string(), V.rows() / 8,
+        (flags & EXACT_COORDINATES) ? "exact" : "rounded");
+}
+
+/// Convert a query recording (see query_recording.hpp) to a scene named after
+/// it next to it (e.g., sim.ccdrec → sim/vertex-face/queries.ccdq), so the
+/// benchmark runs it as a dataset.
+void convert_recording(const fs::path& recording_path)
+{
+    const std::vector<QueryRecord> records
+        = read_query_recording(recording_path.string());
+
+    // The ground truth is that of an exact method, or without one the
+    // recorded answer. Minimum separation queries are treated as CCD.
+    CCDMethod exact_method = NUM_CCD_METHODS;
+    for (const CCDMethod method :
+         { EXPANSION_ROOT_PARITY, RATIONAL_ROOT_PARITY,
+           RATIONAL_FIXED_ROOT_PARITY }) {
+        if (exact_method == NUM_CCD_METHODS && is_method_enabled(method)) {
+            exact_method = method;
+        }
+    }
+
+    const fs::path scene_dir
+        = recording_path.parent_path() / recording_path.stem();
+    for (int is_edge_edge = 0; is_edge_edge < 2; is_edge_edge++) {
+        std::vector<const QueryRecord*> type_records;
+        for (const QueryRecord& record : records) {
+            if (bool(record.flags & RECORDED_EDGE_EDGE) == bool(is_edge_edge)) {
+                type_records.push_back(&record);
+            }
+        }
+        if (type_records.empty()) {
+            continue;
+        }
+
+        Eigen::MatrixXd V(8 * type_records.size(), 3);
+        std::vector<bool> results(V.rows());
+        long num_positives = 0;
+        for (size_t i = 0; i < type_records.size(); i++) {
+            const Eigen::Matrix<double, 8, 3> Q = type_records[i]->query();
+            bool result = type_records[i]->flags & RECORDED_RESULT;
+            if (exact_method != NUM_CCD_METHODS) {
+                result = is_edge_edge
+                    ? edgeEdgeCCD(
+                        Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4),
+                        Q.row(5), Q.row(6), Q.row(7), exact_method)
+                    : vertexFaceCCD(
+                        Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4),
+                        Q.row(5), Q.row(6), Q.row(7), exact_method);
+            }
+            V.middleRows<8>(8 * i) = Q;
+            std::fill_n(results.begin() + 8 * i, 8, result);
+            num_positives += result;
+        }
+
+        const fs::path dir
+            = scene_dir / (is_edge_edge ? "edge-edge" : "vertex-face");
+        fs::create_directories(dir);
+        const fs::path binary_path
+            = dir / (std::string("queries") + BINARY_QUERIES_EXTENSION);
+        write_binary_queries(
+            binary_path.string(), V, results, EXACT_COORDINATES);
+
+        fmt::print(
+            "{} -> {} ({:d} queries, {:d} positive by {})\n",
+            recording_path.string(), binary_path.string(),
+            type_records.size(), num_positives,
+            exact_method != NUM_CCD_METHODS ? method_names[exact_method]
+                                            : "the recorded answers");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "Convert rational CSV queries to the binary query format "
+                   "(written next to each CSV), and query recordings to "
+                   "scenes of binary query files" };
+
+    std::vector<std::string> inputs;
+    app.add_option(
+           "inputs", inputs,
+           "CSV files, query recordings (.ccdrec), or directories to convert")
+        ->required();
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError& e) {
+        return app.exit(e);
+    }
+
+    try {
+        for (const std::string& input : inputs) {
+            if (!fs::is_directory(input)) {
+                if (fs::path(input).extension() == QUERY_RECORDING_EXTENSION) {
+                    convert_recording(input);
+                } else {
+                    convert(input);
+                }
+                continue;
+            }
+            for (const auto& entry : fs::recursive_directory_iterator(input)) {
+                if (entry.path().extension() == ".csv") {
+                    convert(entry.path());
+                } else if (
+                    entry.path().extension() == QUERY_RECORDING_EXTENSION) {
+                    convert_recording(entry.path());
+                }
+            }
+        }
+    } catch (const char* err) {
+        fmt::print(stderr, "Conversion failed: {}\n", err);
+        return 1;
+    }
+}
@@ -0,0 +1,151 @@
+// Generate synthetic and adversarial CCD queries with known ground truth
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <Eigen/Core>
+#include <fmt/format.h>
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <utils/binary_queries.hpp>
+#include <utils/query_generator.hpp>
+#include <utils/read_rational_csv.hpp>
+
+using namespace ccd;
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "Generate synthetic CCD queries with known ground truth "
+                   "(a scene synthetic-<kind> per kind of query)" };
+
+    std::string output_dir;
+    app.add_option("output", output_dir, "data directory to write to")
+        ->required();
+
+    long num_queries = 1000000;
+    app.add_option(
+           "-n,--num-queries", num_queries,
+           "number of queries per query type")
+        ->check(CLI::PositiveNumber)
+        ->default_val(num_queries);
+
+    std::vector<std::string> mix;
+    app.add_option(
+           "--mix", mix,
+           "relative number of queries of each kind as kind=weight (far, "
+           "near-touching, coplanar, parallel, sliding, large-offset; "
+           "default all 1)")
+        ->delimiter(',');
+
+    long file_size = 100000;
+    app.add_option("--file-size", file_size, "queries per file")
+        ->check(CLI::PositiveNumber)
+        ->default_val(file_size);
+
+    bool write_csv = false;
+    app.add_flag(
+        "--csv", write_csv,
+        "write rational CSV files instead of binary query files");
+
+    unsigned seed = 0;
+    app.add_option("--seed", seed, "random seed")->default_val(seed);
+
+    bool generate_vf = true, generate_ee = true;
+    app.add_flag(
+        "!--no-vf", generate_vf, "do not generate vertex-face queries");
+    app.add_flag("!--no-ee", generate_ee, "do not generate edge-edge queries");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError& e) {
+        return app.exit(e);
+    }
+
+    std::vector<double> weights(NUM_QUERY_FAMILIES, mix.empty() ? 1 : 0);
+    for (const std::string& entry : mix) {
+        const size_t split = entry.find('=');
+        const std::string name = entry.substr(0, split);
+        const auto family = std::find(
+            query_family_names, query_family_names + NUM_QUERY_FAMILIES, name);
+        if (family == query_family_names + NUM_QUERY_FAMILIES
+            || split == std::string::npos) {
+            fmt::print(stderr, "Invalid --mix entry: {}\n", entry);
+            return 1;
+        }
+        weights[family - query_family_names]
+            = std::max(std::atof(entry.c_str() + split + 1), 0.0);
+    }
+    double total_weight = 0;
+    for (double weight : weights) {
+        total_weight += weight;
+    }
+    if (total_weight <= 0) {
+        fmt::print(stderr, "--mix has no positive weight\n");
+        return 1;
+    }
+
+    try {
+        for (int is_edge_edge = 0; is_edge_edge < 2; is_edge_edge++) {
+            if (!(is_edge_edge ? generate_ee : generate_vf)) {
+                continue;
+            }
+            // Round the cumulative weights so the counts add up.
+            double cumulative_weight = 0;
+            long num_generated = 0;
+            for (int f = 0; f < NUM_QUERY_FAMILIES; f++) {
+                cumulative_weight += weights[f];
+                const long end = std::lround(
+                    num_queries * cumulative_weight / total_weight);
+                const long family_size = end - num_generated;
+                num_generated = end;
+
+                const fs::path dir = fs::path(output_dir)
+                    / (std::string("synthetic-") + query_family_names[f])
+                    / (is_edge_edge ? "edge-edge" : "vertex-face");
+                if (family_size > 0) {
+                    fs::create_directories(dir);
+                }
+                for (long k = 0; k * file_size < family_size; k++) {
+                    const long n
+                        = std::min(file_size, family_size - k * file_size);
+                    std::seed_seq file_seed = { seed, unsigned(is_edge_edge),
+                                                unsigned(f), unsigned(k) };
+                    QueryGenerator generator(is_edge_edge, file_seed);
+
+                    Eigen::MatrixXd V(8 * n, 3);
+                    std::vector<bool> results(8 * n);
+                    long num_positives = 0;
+                    for (long i = 0; i < n; i++) {
+                        Eigen::Matrix<double, 8, 3> query;
+                        const bool result
+                            = generator.generate(QueryFamily(f), query);
+                        V.middleRows<8>(8 * i) = query;
+                        std::fill_n(results.begin() + 8 * i, 8, result);
+                        num_positives += result;
+                    }
+
+                    const fs::path path = dir
+                        / fmt::format("queries-{:04d}{}", k,
+                                      write_csv ? ".csv"
+                                                : BINARY_QUERIES_EXTENSION);
+                    if (write_csv) {
+                        write_rational_csv(path.string(), V, results);
+                    } else {
+                        write_binary_queries(
+                            path.string(), V, results, EXACT_COORDINATES);
+                    }
+                    fmt::print(
+                        "{} ({:d} queries, {:d} positive)\n", path.string(), n,
+                        num_positives);
+                }
+            }
+        }
+    } catch (const char* err) {
+        fmt::print(stderr, "Generation failed: {}\n", err);
+        return 1;
+    }
+}
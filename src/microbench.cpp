@@ -0,0 +1,288 @@
+// Time each CCD method on small in-memory query sets, one per class of query
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <fmt/format.h>
+
+#include <ccd.hpp>
+#if CCD_WRAPPER_WITH_FXRP
+#include <root_parity/fixed_point_root_parity.hpp>
+#endif
+
+#include <utils/cpu_affinity.hpp>
+#include <utils/query_generator.hpp>
+#include <utils/timer.hpp>
+
+using namespace ccd;
+
+/// Queries of one type and ground truth, degenerate or not.
+struct QueryClass {
+    std::string name;
+    bool is_edge_edge;
+    bool result;
+    std::vector<
+        Eigen::Matrix<double, 8, 3>,
+        Eigen::aligned_allocator<Eigen::Matrix<double, 8, 3>>>
+        queries;
+};
+
+/// Generate n queries of each class: vertex-face and edge-edge, hit and
+/// miss, and generic (far or near-touching) and degenerate (coplanar,
+/// parallel, or sliding).
+std::vector<QueryClass> make_query_classes(const long n, const unsigned seed)
+{
+    std::vector<QueryClass> classes;
+    for (int is_edge_edge = 0; is_edge_edge < 2; is_edge_edge++) {
+        for (int is_degenerate = 0; is_degenerate < 2; is_degenerate++) {
+            for (int result = 1; result >= 0; result--) {
+                QueryClass query_class;
+                query_class.name = fmt::format(
+                    "{} {}{}", is_edge_edge ? "ee" : "vf",
+                    is_degenerate ? "degenerate " : "",
+                    result ? "hit" : "miss");
+                query_class.is_edge_edge = is_edge_edge;
+                query_class.result = result;
+
+                // Take the queries with the result from these families in
+                // turn.
+                std::vector<QueryFamily> families;
+                if (is_degenerate) {
+                    families = { COPLANAR, PARALLEL, SLIDING };
+                } else {
+                    families = { NEAR_TOUCHING };
+                    if (!result) {
+                        families.push_back(FAR);
+                    }
+                }
+
+                std::seed_seq class_seed = { seed, unsigned(is_edge_edge),
+                                             unsigned(is_degenerate),
+                                             unsigned(result) };
+                QueryGenerator generator(is_edge_edge, class_seed);
+                Eigen::Matrix<double, 8, 3> query;
+                for (size_t k = 0; long(query_class.queries.size()) < n; k++) {
+                    if (generator.generate(
+                            families[k % families.size()], query)
+                        == bool(result)) {
+                        query_class.queries.push_back(query);
+                    }
+                }
+                classes.push_back(query_class);
+            }
+        }
+    }
+    return classes;
+}
+
+bool run_ccd(
+    const CCDMethod method,
+    const bool is_edge_edge,
+    const Eigen::Matrix<double, 8, 3>& Q,
+    const double minimum_separation)
+{
+    if (is_minimum_separation_method(method)) {
+        return is_edge_edge
+            ? edgeEdgeMSCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), minimum_separation, method)
+            : vertexFaceMSCCD(
+                Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+                Q.row(6), Q.row(7), minimum_separation, method);
+    }
+    return is_edge_edge
+        ? edgeEdgeCCD(
+            Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+            Q.row(6), Q.row(7), method)
+        : vertexFaceCCD(
+            Q.row(0), Q.row(1), Q.row(2), Q.row(3), Q.row(4), Q.row(5),
+            Q.row(6), Q.row(7), method);
+}
+
+/// Whether the method can run the query: the fixed-point method only takes
+/// queries within its bit budget, and would otherwise fail and answer
+/// conservatively.
+bool is_query_supported(
+    const CCDMethod method, const Eigen::Matrix<double, 8, 3>& Q)
+{
+#if CCD_WRAPPER_WITH_FXRP
+    if (method == CCDMethod::FIXED_POINT_ROOT_PARITY) {
+        return root_parity::fits_fixed_point_budget(Q);
+    }
+#else
+    (void)method, (void)Q;
+#endif
+    return true;
+}
+
+/// Median of the values (reordered).
+double median(std::vector<double>& values)
+{
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double m = values[middle];
+    if (values.size() % 2 == 0) {
+        m = (m + *std::max_element(values.begin(), values.begin() + middle))
+            / 2;
+    }
+    return m;
+}
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "CCD microbenchmark: time each method in a tight loop "
+                   "over small in-memory query sets per class of query" };
+
+    std::vector<CCDMethod> methods;
+    std::vector<std::pair<std::string, CCDMethod>> name_to_method;
+    std::stringstream method_options;
+    method_options << "CCD methods to time\noptions:" << std::endl;
+    for (int i = 0; i < NUM_CCD_METHODS; i++) {
+        method_options << i << ": " << method_names[i];
+        if (is_method_enabled(CCDMethod(i))) {
+            methods.push_back(CCDMethod(i));
+            name_to_method.emplace_back(method_names[i], CCDMethod(i));
+        } else {
+            method_options << " (disabled)";
+        }
+        method_options << "\n";
+    }
+    app.add_option("-m,--methods", methods, method_options.str())
+        ->transform(CLI::CheckedTransformer(name_to_method, CLI::ignore_case))
+        ->default_val(methods);
+
+    long num_queries = 256;
+    app.add_option(
+           "-n,--num-queries", num_queries,
+           "queries per class (small enough to stay in the L1/L2 cache)")
+        ->check(CLI::PositiveNumber)
+        ->default_val(num_queries);
+
+    int num_repetitions = 30, num_warmups = 5;
+    app.add_option(
+           "-r,--repetitions", num_repetitions,
+           "timed passes over each class")
+        ->check(CLI::PositiveNumber)
+        ->default_val(num_repetitions);
+    app.add_option(
+           "-w,--warmup", num_warmups, "untimed passes before the timed ones")
+        ->default_val(num_warmups);
+
+    double minimum_separation = 0;
+    app.add_option(
+           "-d,--minimum-separation", minimum_separation,
+           "minimum separation distance")
+        ->default_val(minimum_separation);
+
+    unsigned seed = 0;
+    app.add_option("--seed", seed, "random seed of the queries")
+        ->default_val(seed);
+
+    int quantization_bits = -1;
+    app.add_option(
+           "--quantize", quantization_bits,
+           "round query coordinates to multiples of 2⁻ᵇ (e.g., so they fit "
+           "the fixed-point method; results may then be wrong)")
+        ->check(CLI::NonNegativeNumber);
+
+    int cpu = -1;
+    app.add_option("--cpu", cpu, "pin to this CPU (e.g., an isolated core)");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError& e) {
+        return app.exit(e);
+    }
+
+    if (cpu >= 0 && !pin_thread_to_cpu(cpu)) {
+        fmt::print(stderr, "warning: unable to pin to CPU {}\n", cpu);
+    }
+
+    std::vector<QueryClass> classes = make_query_classes(num_queries, seed);
+    if (quantization_bits >= 0) {
+        const double scale = std::ldexp(1.0, quantization_bits);
+        for (QueryClass& query_class : classes) {
+            for (auto& query : query_class.queries) {
+                query = ((query * scale).array().round() / scale).matrix();
+            }
+        }
+    }
+
+    fmt::print(
+        "{} queries per class, {} warmup and {} timed passes; time per query "
+        "in ns; skipped queries exceed the input range of the method\n",
+        num_queries, num_warmups, num_repetitions);
+    fmt::print(
+        "{:<32}{:<22}{:>10}{:>10}{:>8}{:>8}{:>9}\n", "method", "class",
+        "median", "min", "±MAD", "wrong", "skipped");
+    for (const CCDMethod method : methods) {
+        if (!is_method_enabled(method)) {
+            fmt::print(
+                stderr, "CCD method {} requested, but it is disabled\n",
+                method_names[method]);
+            continue;
+        }
+        for (const QueryClass& query_class : classes) {
+            // Only the queries the method can take, so failures are not timed
+            std::vector<
+                Eigen::Matrix<double, 8, 3>,
+                Eigen::aligned_allocator<Eigen::Matrix<double, 8, 3>>>
+                queries;
+            for (const auto& query : query_class.queries) {
+                if (is_query_supported(method, query)) {
+                    queries.push_back(query);
+                }
+            }
+            const size_t num_skipped
+                = query_class.queries.size() - queries.size();
+            if (queries.empty()) {
+                fmt::print(
+                    "{:<32}{:<22}{:>10}{:>10}{:>8}{:>8}{:>9}\n",
+                    method_names[method], query_class.name, "-", "-", "-",
+                    "-", num_skipped);
+                continue;
+            }
+
+            std::vector<double> times;
+            long num_wrong = 0;
+            for (int r = -num_warmups; r < num_repetitions; r++) {
+                long num_positives = 0;
+                Timer timer;
+                timer.start();
+                for (const auto& query : queries) {
+                    num_positives += run_ccd(
+                        method, query_class.is_edge_edge, query,
+                        minimum_separation);
+                }
+                timer.stop();
+                if (r >= 0) {
+                    times.push_back(
+                        timer.getElapsedTimeInNanoSec() / queries.size());
+                }
+                num_wrong = query_class.result
+                    ? long(queries.size()) - num_positives
+                    : num_positives;
+            }
+
+            // Median absolute deviation as a robust relative noise level
+            const double min_time
+                = *std::min_element(times.begin(), times.end());
+            const double median_time = median(times);
+            std::vector<double> deviations;
+            for (double time : times) {
+                deviations.push_back(std::abs(time - median_time));
+            }
+            fmt::print(
+                "{:<32}{:<22}{:>10.1f}{:>10.1f}{:>7.2f}%{:>8}{:>9}\n",
+                method_names[method], query_class.name, median_time, min_time,
+                100 * median(deviations) / median_time, num_wrong,
+                num_skipped);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include "query_preprocessing.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace ccd {
+
+namespace {
+
+    /// Is a - b exactly representable? The error term of TwoSum(a, -b)
+    /// [Knuth 1997] is zero iff the rounded difference is exact.
+    bool is_exact_difference(const double a, const double b)
+    {
+        const double x = a - b;
+        const double b_virtual = x - a;
+        const double a_virtual = x - b_virtual;
+        const double b_roundoff = -b - b_virtual;
+        const double a_roundoff = a - a_virtual;
+        return a_roundoff + b_roundoff == 0;
+    }
+
+    void translate(Eigen::Matrix<double, 8, 3>& V)
+    {
+        for (int j = 0; j < 3; j++) {
+            const double origin = V(0, j);
+            bool is_exact = std::isfinite(origin);
+            for (int i = 1; i < 8 && is_exact; i++) {
+                is_exact = is_exact_difference(V(i, j), origin);
+            }
+            // Only translate if it brings the coordinates closer to zero.
+            if (is_exact
+                && (V.col(j).array() - origin).abs().maxCoeff()
+                    < V.col(j).array().abs().maxCoeff()) {
+                V.col(j).array() -= origin;
+            }
+        }
+    }
+
+    double rescale(Eigen::Matrix<double, 8, 3>& V)
+    {
+        const double max_magnitude = V.array().abs().maxCoeff();
+        if (!std::isfinite(max_magnitude) || max_magnitude == 0) {
+            return 1;
+        }
+        int exponent;
+        std::frexp(max_magnitude, &exponent);
+        // Scaling by 2⁻ᵉ is exact unless a coordinate becomes subnormal.
+        const double min_magnitude =
+            std::ldexp(std::numeric_limits<double>::min(), exponent);
+        for (int i = 0; i < V.size(); i++) {
+            if (V(i) != 0 && std::abs(V(i)) < min_magnitude) {
+                return 1;
+            }
+        }
+        const double scale = std::ldexp(1.0, -exponent);
+        V *= scale;
+        return scale;
+    }
+
+} // namespace
+
+double preprocess_query(
+    Eigen::Matrix<double, 8, 3>& V,
+    const QueryPreprocessing preprocessing,
+    const CCDMethod method)
+{
+    if (preprocessing == NO_PREPROCESSING) {
+        return 1;
+    }
+    translate(V);
+    if (preprocessing == TRANSLATE_AND_RESCALE
+        && is_scale_invariant_method(method)) {
+        return rescale(V);
+    }
+    return 1;
+}
+
+} // namespace ccd
@@ -0,0 +1,48 @@
+/// @brief Error-free normalization of CCD queries before dispatch
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <ccd.hpp>
+
+namespace ccd {
+
+/// How a query is normalized before it is passed to a CCD method.
+enum QueryPreprocessing {
+    /// Pass the query unchanged.
+    NO_PREPROCESSING,
+    /// Translate the query to a local origin.
+    TRANSLATE,
+    /// Translate, then rescale by a power of two (scale-invariant methods).
+    TRANSLATE_AND_RESCALE,
+};
+
+/**
+ * @brief Move a query closer to the origin without changing the problem.
+ *
+ * Each axis is translated by the first point's coordinate if that reduces
+ * its largest magnitude and every difference on the axis is computed
+ * exactly, so the translated query is a rigid motion of the original. Since
+ * collisions are invariant under rigid motions, every method solves the same
+ * problem, and the exact methods stay exact.
+ *
+ * Rescaling multiplies all coordinates by 2ᵏ so that the largest magnitude is
+ * in [1/2, 1). It is skipped if any coordinate would lose bits to underflow.
+ * Distances that are part of the problem (minimum separation, the Tight
+ * Inclusion tolerance) must be multiplied by the returned scale. Rescaling
+ * is only applied for methods where is_scale_invariant_method() is true.
+ *
+ * @param[in,out] V   The eight points of a vertex-face or edge-edge query in
+ *                    the argument order of the CCD functions.
+ * @param[in] preprocessing  Which normalization to apply.
+ * @param[in] method  Method the query will be dispatched to.
+ *
+ * @return The scale 2ᵏ applied to the query (1 if not rescaled).
+ */
+double preprocess_query(
+    Eigen::Matrix<double, 8, 3>& V,
+    const QueryPreprocessing preprocessing,
+    const CCDMethod method);
+
+} // namespace ccd
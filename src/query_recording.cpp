@@ -0,0 +1,259 @@
+#include "query_recording.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+
+namespace ccd {
+
+namespace {
+    const char MAGIC[8] = { 'C', 'C', 'D', 'Q', 'R', 'L', 'O', 'G' };
+
+    struct ThreadRecords;
+
+    /// The log and the threads with records for it. Locked before the
+    /// mutex of a thread's buffer, never after.
+    struct Recording {
+        std::mutex mutex;
+        std::FILE* file = nullptr;
+        /// Also changed with the mutex of every buffer held, so a thread can
+        /// read them with only its own.
+        QueryRecordingOptions options;
+        /// Of the current recording, advanced by every start and stop (and
+        /// also changed with the mutex of every buffer held)
+        std::atomic<uint64_t> generation { 0 };
+        std::vector<ThreadRecords*> threads;
+        unsigned num_threads = 0; ///< ever registered, to seed the sampling
+    };
+
+    Recording& recording()
+    {
+        static Recording recording;
+        return recording;
+    }
+
+    std::atomic<bool> is_recording(false);
+
+    /// Write records to the log (with the mutex held) and clear them.
+    void write_records(Recording& recording, std::vector<QueryRecord>& records)
+    {
+        if (recording.file != nullptr && !records.empty()) {
+            std::fwrite(
+                records.data(), sizeof(QueryRecord), records.size(),
+                recording.file);
+        }
+        records.clear();
+    }
+
+    /// Buffer of a thread, registered from its first recorded call until the
+    /// thread exits.
+    struct ThreadRecords {
+        /// Guards records against stop_query_recording, the only other
+        /// thread that takes it.
+        std::mutex mutex;
+        std::vector<QueryRecord> records;
+        std::mt19937 rng;
+        bool is_in_call = false;
+        bool is_fallback = false;
+        uint64_t generation = 0; ///< of the recording the call started in
+
+        ThreadRecords()
+        {
+            Recording& r = recording();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            std::seed_seq seed = { r.options.seed, r.num_threads++ };
+            rng.seed(seed);
+            records.reserve(r.options.buffer_size);
+            r.threads.push_back(this);
+        }
+
+        ~ThreadRecords()
+        {
+            Recording& r = recording();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            std::lock_guard<std::mutex> records_lock(mutex);
+            write_records(r, records);
+            r.threads.erase(
+                std::find(r.threads.begin(), r.threads.end(), this));
+        }
+    };
+
+    ThreadRecords& thread_records()
+    {
+        thread_local ThreadRecords records;
+        return records;
+    }
+
+    /// Lock the buffers of all threads (with the mutex held).
+    std::vector<std::unique_lock<std::mutex>>
+    lock_thread_records(Recording& recording)
+    {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (ThreadRecords* thread : recording.threads) {
+            locks.emplace_back(thread->mutex);
+        }
+        return locks;
+    }
+} // namespace
+
+bool start_query_recording(const QueryRecordingOptions& options)
+{
+    if (!CCD_WRAPPER_WITH_QUERY_RECORDING) {
+        return false;
+    }
+    Recording& r = recording();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.file != nullptr) {
+        throw "queries are already being recorded";
+    }
+    r.file = std::fopen(options.path.c_str(), "wb");
+    if (r.file == nullptr) {
+        throw "unable to create the query recording";
+    }
+
+    QueryRecordingHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = QUERY_RECORDING_VERSION;
+    header.record_size = sizeof(QueryRecord);
+    header.reserved[0] = header.reserved[1] = 0;
+    std::fwrite(&header, sizeof(header), 1, r.file);
+
+    {
+        const auto locks = lock_thread_records(r);
+        r.options = options;
+        r.options.buffer_size = std::max<size_t>(options.buffer_size, 1);
+        r.generation.fetch_add(1, std::memory_order_release);
+    }
+    is_recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void stop_query_recording()
+{
+    is_recording.store(false, std::memory_order_release);
+    Recording& r = recording();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const auto locks = lock_thread_records(r);
+    for (ThreadRecords* thread : r.threads) {
+        write_records(r, thread->records);
+    }
+    // The calls still running are not recorded.
+    r.generation.fetch_add(1, std::memory_order_release);
+    if (r.file != nullptr) {
+        std::fclose(r.file);
+        r.file = nullptr;
+    }
+}
+
+std::vector<QueryRecord> read_query_recording(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw "unable to open the query recording";
+    }
+    QueryRecordingHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw "not a query recording";
+    }
+    if (header.version != QUERY_RECORDING_VERSION
+        || header.record_size != sizeof(QueryRecord)) {
+        throw "unsupported query recording version";
+    }
+
+    std::vector<QueryRecord> records;
+    QueryRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    if (file.gcount() != 0) {
+        throw "truncated query recording";
+    }
+    return records;
+}
+
+bool should_record_query()
+{
+    return is_recording.load(std::memory_order_acquire)
+        && !thread_records().is_in_call;
+}
+
+void begin_recorded_query()
+{
+    ThreadRecords& thread = thread_records();
+    thread.is_in_call = true;
+    thread.is_fallback = false;
+    thread.generation = recording().generation.load(std::memory_order_acquire);
+}
+
+void note_query_fallback()
+{
+    if (is_recording.load(std::memory_order_acquire)) {
+        thread_records().is_fallback = true;
+    }
+}
+
+void finish_recorded_query(
+    const Eigen::Vector3d* const points[8],
+    const bool is_edge_edge,
+    const CCDMethod method,
+    const bool is_msccd,
+    const double min_distance,
+    const double tolerance,
+    const long max_iter,
+    const bool result,
+    const double time)
+{
+    ThreadRecords& thread = thread_records();
+    thread.is_in_call = false;
+
+    // Dropped if the recording it started in was stopped meanwhile
+    Recording& r = recording();
+    std::unique_lock<std::mutex> lock(thread.mutex);
+    if (!is_recording.load(std::memory_order_acquire)
+        || thread.generation != r.generation.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const QueryRecordingOptions& options = r.options;
+    if (!((options.methods >> method) & 1) || time < options.min_time
+        || (options.only_fallbacks && !thread.is_fallback)) {
+        return;
+    }
+    if (options.sample_rate < 1
+        && !(std::uniform_real_distribution<double>()(thread.rng)
+             < options.sample_rate)) {
+        return;
+    }
+
+    QueryRecord record;
+    std::memset(&record, 0, sizeof(record));
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 3; j++) {
+            record.points[i][j] = (*points[i])[j];
+        }
+    }
+    record.min_distance = min_distance;
+    record.tolerance = tolerance;
+    record.max_iter = max_iter;
+    record.time = float(time);
+    record.method = uint8_t(method);
+    record.flags = (is_edge_edge ? RECORDED_EDGE_EDGE : 0)
+        | (result ? RECORDED_RESULT : 0)
+        | (thread.is_fallback ? RECORDED_FALLBACK : 0)
+        | (is_msccd ? RECORDED_MSCCD : 0);
+    thread.records.push_back(record);
+
+    if (thread.records.size() >= options.buffer_size) {
+        // In lock order; a stop meanwhile has written them to its log.
+        lock.unlock();
+        std::lock_guard<std::mutex> recording_lock(r.mutex);
+        lock.lock();
+        write_records(r, thread.records);
+    }
+}
+
+} // namespace ccd
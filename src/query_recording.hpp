@@ -0,0 +1,146 @@
+/// @brief Recording of the queries of the CCD functions for offline replay
+///
+/// The CCD functions only call the recorder when compiled with
+/// CCD_WRAPPER_WITH_QUERY_RECORDING; otherwise they have no recording code at
+/// all, and logs can only be read.
+///
+/// Log layout (in the byte order of the host):
+///   1. QueryRecordingHeader (32 bytes)
+///   2. QueryRecord per recorded call, in the order the threads flushed them
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <ccd.hpp>
+
+namespace ccd {
+
+/// File extension of query recordings (convert them with
+/// ccd_convert_queries).
+static const char* const QUERY_RECORDING_EXTENSION = ".ccdrec";
+
+struct QueryRecordingHeader {
+    char magic[8];        ///< "CCDQRLOG"
+    uint32_t version;     ///< QUERY_RECORDING_VERSION
+    uint32_t record_size; ///< sizeof(QueryRecord)
+    uint64_t reserved[2]; ///< Zero
+};
+static_assert(
+    sizeof(QueryRecordingHeader) == 32, "unexpected header padding");
+
+static const uint32_t QUERY_RECORDING_VERSION = 1;
+
+enum QueryRecordFlags : uint8_t {
+    RECORDED_EDGE_EDGE = 1, ///< else vertex-face
+    RECORDED_RESULT = 2,    ///< the answer of the method
+    RECORDED_FALLBACK = 4,  ///< the method failed and answered conservatively
+    RECORDED_MSCCD = 8,     ///< called as minimum separation CCD
+};
+
+/// One call of a CCD function.
+struct QueryRecord {
+    double points[8][3]; ///< in the argument order of the CCD functions
+    double min_distance; ///< 0 unless RECORDED_MSCCD
+    double tolerance;    ///< Tight Inclusion δ
+    int64_t max_iter;    ///< Tight Inclusion maximum iterations
+    float time;          ///< ns
+    uint8_t method;      ///< CCDMethod
+    uint8_t flags;       ///< QueryRecordFlags
+    uint8_t padding[2];
+
+    /// The points as a query of the benchmark (see binary_queries.hpp).
+    Eigen::Matrix<double, 8, 3> query() const
+    {
+        return Eigen::Map<const Eigen::Matrix<double, 8, 3, Eigen::RowMajor>>(
+            &points[0][0]);
+    }
+};
+static_assert(sizeof(QueryRecord) == 224, "unexpected record padding");
+
+/// Which calls of the CCD functions to record.
+struct QueryRecordingOptions {
+    std::string path; ///< log to write (overwritten)
+    /// Bit m set to record the calls of CCDMethod m
+    uint32_t methods = ~uint32_t(0);
+    double min_time = 0;         ///< only calls at least this slow (ns)
+    bool only_fallbacks = false; ///< only calls where the method failed
+    double sample_rate = 1;      ///< fraction of the matching calls kept
+    unsigned seed = 0;           ///< of the sampling
+    size_t buffer_size = 1024;   ///< records per thread between writes
+};
+
+/**
+ * @brief Start recording the calls of the CCD functions to a log.
+ *
+ * Each thread appends its records to a buffer of its own under a mutex of
+ * its own (only contended by stop_query_recording), and only takes the lock
+ * of the log to write the buffer when it is full or the thread exits. Calls
+ * made by a CCD function being recorded are not recorded. Throws a
+ * const char* if the log cannot be created.
+ *
+ * @return False (and nothing is recorded) if the CCD functions were compiled
+ *         without CCD_WRAPPER_WITH_QUERY_RECORDING.
+ */
+bool start_query_recording(const QueryRecordingOptions& options);
+
+/// Write the buffers of all threads and close the log. The calls still
+/// running in other threads are not recorded, in this log or a later one.
+void stop_query_recording();
+
+/// Read the records of a log. Throws a const char* if it is not valid.
+std::vector<QueryRecord> read_query_recording(const std::string& path);
+
+/// Whether a CCD function should record its call: recording is on and the
+/// call is not made by another recorded call.
+bool should_record_query();
+
+/// Start a recorded call (see record_query).
+void begin_recorded_query();
+
+/// Mark the current recorded call as answered conservatively after a failure.
+void note_query_fallback();
+
+/// Record a call once it returned (see record_query).
+void finish_recorded_query(
+    const Eigen::Vector3d* const points[8],
+    const bool is_edge_edge,
+    const CCDMethod method,
+    const bool is_msccd,
+    const double min_distance,
+    const double tolerance,
+    const long max_iter,
+    const bool result,
+    const double time);
+
+/// Run a CCD call and record it (if should_record_query()).
+/// @param ccd  The call, run as a nested call so it is not recorded again.
+template <typename CCDCall>
+bool record_query(
+    const Eigen::Vector3d* const points[8],
+    const bool is_edge_edge,
+    const CCDMethod method,
+    const bool is_msccd,
+    const double min_distance,
+    const double tolerance,
+    const long max_iter,
+    CCDCall ccd)
+{
+    begin_recorded_query();
+    const auto start = std::chrono::steady_clock::now();
+    const bool result = ccd();
+    const double time = std::chrono::duration<double, std::nano>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    finish_recorded_query(
+        points, is_edge_edge, method, is_msccd, min_distance, tolerance,
+        max_iter, result, time);
+    return result;
+}
+
+} // namespace ccd
@@ -0,0 +1,311 @@
+/// @brief Exact floating-point expansion arithmetic of [Shewchuk 1997]
+
+#pragma once
+
+
+namespace ccd {
+namespace root_parity {
+
+/**
+ * @brief Exact sum of doubles with a fixed capacity.
+ *
+ * The value is the sum of the components, which are nonzero, nonoverlapping
+ * and sorted by increasing magnitude, so the sign of the value is the sign of
+ * the last component. Components live inside the object; an operation whose
+ * result could exceed the capacity throws instead of allocating.
+ *
+ * The arithmetic is exact as long as no intermediate product overflows or
+ * underflows. Callers guarantee this by bounding the exponents of the inputs.
+ */
+class Expansion {
+public:
+    static const int CAPACITY = 128;
+
+    Expansion()
+        : n(0)
+    {
+    }
+
+    Expansion(double a)
+        : n(a != 0)
+    {
+        e[0] = a;
+    }
+
+    Expansion(const Expansion& other) { assign(other.e, other.n); }
+
+    Expansion& operator=(const Expansion& other)
+    {
+        if (this != &other) {
+            assign(other.e, other.n);
+        }
+        return *this;
+    }
+
+    /// Number of nonzero components.
+    int size() const { return n; }
+
+    /// Sign of the exact value.
+    int sign() const { return n == 0 ? 0 : (e[n - 1] > 0 ? 1 : -1); }
+
+    /// Floating-point approximation of the value.
+    double estimate() const
+    {
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += e[i];
+        }
+        return sum;
+    }
+
+    friend Expansion operator-(const Expansion& a)
+    {
+        Expansion r;
+        r.n = a.n;
+        for (int i = 0; i < a.n; i++) {
+            r.e[i] = -a.e[i];
+        }
+        return r;
+    }
+
+    friend Expansion operator+(const Expansion& a, const Expansion& b)
+    {
+        if (a.n == 0) {
+            return b;
+        }
+        if (b.n == 0) {
+            return a;
+        }
+        check_capacity(a.n + b.n);
+        Expansion r;
+        r.n = fast_expansion_sum_zeroelim(a.n, a.e, b.n, b.e, r.e);
+        r.compress();
+        return r;
+    }
+
+    friend Expansion operator-(const Expansion& a, const Expansion& b)
+    {
+        return a + (-b);
+    }
+
+    friend Expansion operator*(const Expansion& a, const Expansion& b)
+    {
+        if (b.n > a.n) {
+            return b * a;
+        }
+        Expansion r;
+        if (b.n == 0) {
+            return r;
+        }
+        check_capacity(2 * a.n);
+        // Accumulate a·b_i for every component of the shorter factor b,
+        // compressing as we go so the partial sums stay short.
+        double scaled[CAPACITY], sum[2 * CAPACITY];
+        r.n = scale_expansion_zeroelim(a.n, a.e, b.e[0], r.e);
+        r.compress();
+        for (int i = 1; i < b.n; i++) {
+            const int scaled_n =
+                scale_expansion_zeroelim(a.n, a.e, b.e[i], scaled);
+            r.assign(
+                sum,
+                fast_expansion_sum_zeroelim(r.n, r.e, scaled_n, scaled, sum));
+            r.compress();
+        }
+        return r;
+    }
+
+    Expansion& operator+=(const Expansion& x) { return *this = *this + x; }
+    Expansion& operator-=(const Expansion& x) { return *this = *this - x; }
+    Expansion& operator*=(const Expansion& x) { return *this = *this * x; }
+
+private:
+    int n;
+    double e[CAPACITY];
+
+    // Replaces the components with the first m components of x.
+    void assign(const double* x, int m)
+    {
+        check_capacity(m);
+        for (int i = 0; i < m; i++) {
+            e[i] = x[i];
+        }
+        n = m;
+    }
+
+    static void check_capacity(int size)
+    {
+        if (size > CAPACITY) {
+            throw "expansion capacity exceeded";
+        }
+    }
+
+    // Error-free transformations ---------------------------------------------
+
+    // Requires |a| ≥ |b|.
+    static void fast_two_sum(double a, double b, double& x, double& y)
+    {
+        x = a + b;
+        double b_virtual = x - a;
+        y = b - b_virtual;
+    }
+
+    static void two_sum(double a, double b, double& x, double& y)
+    {
+        x = a + b;
+        double b_virtual = x - a;
+        double a_virtual = x - b_virtual;
+        double b_roundoff = b - b_virtual;
+        double a_roundoff = a - a_virtual;
+        y = a_roundoff + b_roundoff;
+    }
+
+    // Veltkamp splitting into two 26-bit halves.
+    static void split(double a, double& hi, double& lo)
+    {
+        const double splitter = 134217729.0; // 2^27 + 1
+        double c = splitter * a;
+        double a_big = c - a;
+        hi = c - a_big;
+        lo = a - hi;
+    }
+
+    // Dekker's product; does not rely on a fused multiply-add.
+    static void two_product(double a, double b, double& x, double& y)
+    {
+        x = a * b;
+        double a_hi, a_lo, b_hi, b_lo;
+        split(a, a_hi, a_lo);
+        split(b, b_hi, b_lo);
+        double err1 = x - (a_hi * b_hi);
+        double err2 = err1 - (a_lo * b_hi);
+        double err3 = err2 - (a_hi * b_lo);
+        y = (a_lo * b_lo) - err3;
+    }
+
+    // Expansion operations ----------------------------------------------------
+
+    // h = e + f. Requires elen, flen ≥ 1 and strongly nonoverlapping inputs.
+    static int fast_expansion_sum_zeroelim(
+        int elen, const double* e, int flen, const double* f, double* h)
+    {
+        double Q, Q_new, hh;
+        int ei = 0, fi = 0, hi = 0;
+        double e_now = e[0], f_now = f[0];
+        if ((f_now > e_now) == (f_now > -e_now)) {
+            Q = e_now;
+            e_now = ++ei < elen ? e[ei] : 0;
+        } else {
+            Q = f_now;
+            f_now = ++fi < flen ? f[fi] : 0;
+        }
+        if (ei < elen && fi < flen) {
+            if ((f_now > e_now) == (f_now > -e_now)) {
+                fast_two_sum(e_now, Q, Q_new, hh);
+                e_now = ++ei < elen ? e[ei] : 0;
+            } else {
+                fast_two_sum(f_now, Q, Q_new, hh);
+                f_now = ++fi < flen ? f[fi] : 0;
+            }
+            Q = Q_new;
+            if (hh != 0) {
+                h[hi++] = hh;
+            }
+            while (ei < elen && fi < flen) {
+                if ((f_now > e_now) == (f_now > -e_now)) {
+                    two_sum(Q, e_now, Q_new, hh);
+                    e_now = ++ei < elen ? e[ei] : 0;
+                } else {
+                    two_sum(Q, f_now, Q_new, hh);
+                    f_now = ++fi < flen ? f[fi] : 0;
+                }
+                Q = Q_new;
+                if (hh != 0) {
+                    h[hi++] = hh;
+                }
+            }
+        }
+        while (ei < elen) {
+            two_sum(Q, e_now, Q_new, hh);
+            e_now = ++ei < elen ? e[ei] : 0;
+            Q = Q_new;
+            if (hh != 0) {
+                h[hi++] = hh;
+            }
+        }
+        while (fi < flen) {
+            two_sum(Q, f_now, Q_new, hh);
+            f_now = ++fi < flen ? f[fi] : 0;
+            Q = Q_new;
+            if (hh != 0) {
+                h[hi++] = hh;
+            }
+        }
+        if (Q != 0) {
+            h[hi++] = Q;
+        }
+        return hi;
+    }
+
+    // h = b·e. Requires elen ≥ 1.
+    static int
+    scale_expansion_zeroelim(int elen, const double* e, double b, double* h)
+    {
+        double Q, hh, product1, product0, sum;
+        int hi = 0;
+        two_product(e[0], b, Q, hh);
+        if (hh != 0) {
+            h[hi++] = hh;
+        }
+        for (int ei = 1; ei < elen; ei++) {
+            two_product(e[ei], b, product1, product0);
+            two_sum(Q, product0, sum, hh);
+            if (hh != 0) {
+                h[hi++] = hh;
+            }
+            fast_two_sum(product1, sum, Q, hh);
+            if (hh != 0) {
+                h[hi++] = hh;
+            }
+        }
+        if (Q != 0) {
+            h[hi++] = Q;
+        }
+        return hi;
+    }
+
+    // Rewrite the expansion as a nonadjacent one with as few components as
+    // possible (Shewchuk's Compress).
+    void compress()
+    {
+        if (n < 2) {
+            return;
+        }
+        double g[CAPACITY];
+        int bottom = n - 1;
+        double Q = e[bottom], Q_new, q;
+        for (int i = n - 2; i >= 0; i--) {
+            fast_two_sum(Q, e[i], Q_new, q);
+            if (q != 0) {
+                g[bottom--] = Q_new;
+                Q = q;
+            } else {
+                Q = Q_new;
+            }
+        }
+        int top = 0;
+        for (int i = bottom + 1; i < n; i++) {
+            fast_two_sum(g[i], Q, Q_new, q);
+            if (q != 0) {
+                e[top++] = q;
+            }
+            Q = Q_new;
+        }
+        e[top++] = Q;
+        n = Q != 0 || top > 1 ? top : 0;
+    }
+};
+
+inline int sign(const Expansion& x) { return x.sign(); }
+
+} // namespace root_parity
+} // namespace ccd
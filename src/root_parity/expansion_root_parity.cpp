@@ -0,0 +1,79 @@
+#include "expansion_root_parity.hpp"
+
+#include <cmath>
+
+#include <root_parity/expansion.hpp>
+#include <root_parity/root_parity.hpp>
+
+namespace ccd {
+namespace root_parity {
+
+namespace {
+
+    // The predicates have degree at most six in the coordinate differences.
+    // Keeping every nonzero input in [2⁻¹²⁰, 2¹²⁰] keeps the lowest bit of any
+    // exact intermediate above 2⁻¹⁰⁷⁴ and its magnitude far below 2¹⁰²³.
+    const double MIN_MAGNITUDE = std::ldexp(1.0, -120);
+    const double MAX_MAGNITUDE = std::ldexp(1.0, 120);
+
+    std::array<Vector3<Expansion>, 8> to_expansions(
+        const Eigen::Vector3d& x0,
+        const Eigen::Vector3d& x1,
+        const Eigen::Vector3d& x2,
+        const Eigen::Vector3d& x3,
+        const Eigen::Vector3d& x4,
+        const Eigen::Vector3d& x5,
+        const Eigen::Vector3d& x6,
+        const Eigen::Vector3d& x7)
+    {
+        const Eigen::Vector3d* x[8] = { &x0, &x1, &x2, &x3,
+                                        &x4, &x5, &x6, &x7 };
+        std::array<Vector3<Expansion>, 8> v;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 3; j++) {
+                const double a = std::abs((*x[i])[j]);
+                if (a != 0 && !(a >= MIN_MAGNITUDE && a <= MAX_MAGNITUDE)) {
+                    throw "input out of range for expansion arithmetic";
+                }
+                v[i][j] = (*x[i])[j];
+            }
+        }
+        return v;
+    }
+
+} // namespace
+
+bool vertexFaceCCD_expansion(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end)
+{
+    return vertexFaceRootParity(to_expansions(
+        vertex_start, face_vertex0_start, face_vertex1_start,
+        face_vertex2_start, vertex_end, face_vertex0_end, face_vertex1_end,
+        face_vertex2_end));
+}
+
+bool edgeEdgeCCD_expansion(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end)
+{
+    return edgeEdgeRootParity(to_expansions(
+        edge0_vertex0_start, edge0_vertex1_start, edge1_vertex0_start,
+        edge1_vertex1_start, edge0_vertex0_end, edge0_vertex1_end,
+        edge1_vertex0_end, edge1_vertex1_end));
+}
+
+} // namespace root_parity
+} // namespace ccd
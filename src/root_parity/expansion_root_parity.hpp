@@ -0,0 +1,47 @@
+/// @brief Exact root parity CCD using floating-point expansions
+
+#pragma once
+
+#include <Eigen/Core>
+
+namespace ccd {
+namespace root_parity {
+
+/**
+ * @brief Exact root parity vertex-face CCD without GMP or heap allocations.
+ *
+ * Every predicate of root parity is evaluated exactly with floating-point
+ * expansions. Nonzero input coordinates must have a magnitude in
+ * [2⁻¹²⁰, 2¹²⁰] so that no intermediate product underflows or overflows.
+ *
+ * @throws const char* if the input is out of range.
+ */
+bool vertexFaceCCD_expansion(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end);
+
+/**
+ * @brief Exact root parity edge-edge CCD without GMP or heap allocations.
+ *
+ * @see vertexFaceCCD_expansion for the valid input range.
+ *
+ * @throws const char* if the input is out of range.
+ */
+bool edgeEdgeCCD_expansion(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end);
+
+} // namespace root_parity
+} // namespace ccd
@@ -0,0 +1,107 @@
+/// @brief Floating-point numbers with a certified forward error bound
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+namespace ccd {
+namespace root_parity {
+
+/// Thrown when the sign of a Filtered value cannot be certified.
+struct UncertainSign {
+};
+
+/**
+ * @brief A double together with a bound on its distance to the exact value.
+ *
+ * Every operation rounds to nearest, so its result is off by at most
+ * u·|result| (u = 2⁻⁵³) on top of the propagated input errors. The bound
+ * itself is evaluated in double; inflating it by (1 + 2⁻⁴⁸) covers the few
+ * roundings made while computing it, and a small absolute term covers
+ * underflow. Overflow or NaN make every comparison fail, so the sign is
+ * reported as uncertain rather than wrong.
+ *
+ * The sign of a value is certain iff |value| > error (or both are zero),
+ * otherwise sign() throws UncertainSign and the caller falls back to exact
+ * arithmetic.
+ */
+class Filtered {
+public:
+    Filtered(double a = 0)
+        : value(a)
+        , error(0)
+    {
+    }
+
+    /// Rounded value.
+    double estimate() const { return value; }
+
+    /// Bound on |exact - estimate()|.
+    double error_bound() const { return error; }
+
+    friend Filtered operator-(const Filtered& a)
+    {
+        return Filtered(-a.value, a.error);
+    }
+
+    friend Filtered operator+(const Filtered& a, const Filtered& b)
+    {
+        const double v = a.value + b.value;
+        return Filtered(v, inflate(a.error + b.error + U * std::abs(v)));
+    }
+
+    friend Filtered operator-(const Filtered& a, const Filtered& b)
+    {
+        const double v = a.value - b.value;
+        return Filtered(v, inflate(a.error + b.error + U * std::abs(v)));
+    }
+
+    friend Filtered operator*(const Filtered& a, const Filtered& b)
+    {
+        const double v = a.value * b.value;
+        return Filtered(
+            v,
+            inflate(
+                std::abs(a.value) * b.error + std::abs(b.value) * a.error
+                + a.error * b.error + U * std::abs(v)));
+    }
+
+    /// Certified sign of the exact value.
+    /// @throws UncertainSign if the error bound does not exclude zero.
+    friend int sign(const Filtered& x)
+    {
+        if (x.value > x.error) {
+            return 1;
+        }
+        if (x.value < -x.error) {
+            return -1;
+        }
+        if (x.value == 0 && x.error == 0) {
+            return 0;
+        }
+        throw UncertainSign();
+    }
+
+private:
+    double value;
+    double error; ///< |exact - value| ≤ error
+
+    /// Unit roundoff
+    static constexpr double U = std::numeric_limits<double>::epsilon() / 2;
+
+    Filtered(double v, double e)
+        : value(v)
+        , error(e)
+    {
+    }
+
+    static double inflate(double e)
+    {
+        return e * (1 + 32 * U)
+            + 32 * std::numeric_limits<double>::denorm_min();
+    }
+};
+
+} // namespace root_parity
+} // namespace ccd
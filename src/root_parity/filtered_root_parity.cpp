@@ -0,0 +1,98 @@
+#include "filtered_root_parity.hpp"
+
+#include <root_parity/filtered.hpp>
+#include <root_parity/root_parity.hpp>
+
+namespace ccd {
+namespace root_parity {
+
+namespace {
+
+    // Per thread so concurrent benchmark runs do not mix their counts
+    thread_local FilterStatistics statistics = { 0, 0 };
+
+    std::array<Vector3<Filtered>, 8> to_filtered(
+        const Eigen::Vector3d& x0,
+        const Eigen::Vector3d& x1,
+        const Eigen::Vector3d& x2,
+        const Eigen::Vector3d& x3,
+        const Eigen::Vector3d& x4,
+        const Eigen::Vector3d& x5,
+        const Eigen::Vector3d& x6,
+        const Eigen::Vector3d& x7)
+    {
+        const Eigen::Vector3d* x[8] = { &x0, &x1, &x2, &x3,
+                                        &x4, &x5, &x6, &x7 };
+        std::array<Vector3<Filtered>, 8> v;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 3; j++) {
+                v[i][j] = (*x[i])[j];
+            }
+        }
+        return v;
+    }
+
+    template <typename RootParityFunction>
+    bool run_filter(
+        RootParityFunction root_parity_function,
+        const std::array<Vector3<Filtered>, 8>& v,
+        bool& collision)
+    {
+        statistics.num_queries++;
+        try {
+            collision = root_parity_function(v);
+        } catch (const UncertainSign&) {
+            return false;
+        }
+        statistics.num_certified++;
+        return true;
+    }
+
+} // namespace
+
+bool vertexFaceCCD_filtered(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end,
+    bool& collision)
+{
+    return run_filter(
+        vertexFaceRootParity<Filtered>,
+        to_filtered(
+            vertex_start, face_vertex0_start, face_vertex1_start,
+            face_vertex2_start, vertex_end, face_vertex0_end,
+            face_vertex1_end, face_vertex2_end),
+        collision);
+}
+
+bool edgeEdgeCCD_filtered(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end,
+    bool& collision)
+{
+    return run_filter(
+        edgeEdgeRootParity<Filtered>,
+        to_filtered(
+            edge0_vertex0_start, edge0_vertex1_start, edge1_vertex0_start,
+            edge1_vertex1_start, edge0_vertex0_end, edge0_vertex1_end,
+            edge1_vertex0_end, edge1_vertex1_end),
+        collision);
+}
+
+FilterStatistics filter_statistics() { return statistics; }
+
+void reset_filter_statistics() { statistics = { 0, 0 }; }
+
+} // namespace root_parity
+} // namespace ccd
@@ -0,0 +1,65 @@
+/// @brief Floating-point filter in front of the exact root parity methods
+
+#pragma once
+
+#include <cstdint>
+
+#include <Eigen/Core>
+
+namespace ccd {
+namespace root_parity {
+
+/**
+ * @brief Root parity vertex-face CCD in double with certified error bounds.
+ *
+ * Runs the root parity predicates on Filtered numbers. If every sign is
+ * certain, the answer is the exact root parity answer; otherwise the query
+ * is near a degeneracy and must be decided by an exact method.
+ *
+ * @param[out] collision  Exact result if the filter succeeded.
+ * @return True iff the filter certified the result.
+ */
+bool vertexFaceCCD_filtered(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end,
+    bool& collision);
+
+/**
+ * @brief Root parity edge-edge CCD in double with certified error bounds.
+ *
+ * @see vertexFaceCCD_filtered
+ *
+ * @param[out] collision  Exact result if the filter succeeded.
+ * @return True iff the filter certified the result.
+ */
+bool edgeEdgeCCD_filtered(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end,
+    bool& collision);
+
+/// Number of queries seen by the filter and how many it decided.
+struct FilterStatistics {
+    uint64_t num_queries;
+    uint64_t num_certified;
+};
+
+/// Counts of the calling thread since its last reset.
+FilterStatistics filter_statistics();
+
+/// Reset the counts of the calling thread.
+void reset_filter_statistics();
+
+} // namespace root_parity
+} // namespace ccd
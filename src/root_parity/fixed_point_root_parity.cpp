@@ -0,0 +1,151 @@
+#include "fixed_point_root_parity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <root_parity/int256.hpp>
+#include <root_parity/root_parity.hpp>
+
+namespace ccd {
+namespace root_parity {
+
+// Corner differences are below 2^(B+1) in magnitude, and the largest
+// predicate, φ = [a,b,c][a,c,d] - [a,b,d][b,c,d], is below 72·2^(6(B+1)).
+static_assert(
+    6 * (FIXED_POINT_BITS + 1) + 7 < 255,
+    "FIXED_POINT_BITS is too large for 256-bit predicates");
+
+namespace {
+
+    /// Exponent of 0 on any grid
+    const int NO_BITS = std::numeric_limits<int>::min() / 2;
+
+    /// Smallest f such that x·2ᶠ is an integer (negative if x is a multiple
+    /// of a power of two above 1).
+    int fractional_bits(double x)
+    {
+        if (x == 0) {
+            return NO_BITS;
+        }
+        int exponent;
+        // x = mantissa·2^(exponent - 53) with an integer mantissa
+        int64_t mantissa = int64_t(std::ldexp(std::frexp(x, &exponent), 53));
+        int f = 53 - exponent;
+        while ((mantissa & 1) == 0) {
+            mantissa /= 2;
+            f--;
+        }
+        return f;
+    }
+
+    /// Find the exponent f of the coarsest grid 2⁻ᶠℤ containing every
+    /// coordinate.
+    /// @return False if a coordinate is not finite or exceeds the bit budget
+    ///         on the grid.
+    bool fixed_point_exponent(const Eigen::Vector3d* const x[8], int& f)
+    {
+        f = NO_BITS;
+        double max_magnitude = 0;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 3; j++) {
+                if (!std::isfinite((*x[i])[j])) {
+                    return false;
+                }
+                f = std::max(f, fractional_bits((*x[i])[j]));
+                max_magnitude = std::max(max_magnitude, std::abs((*x[i])[j]));
+            }
+        }
+        return max_magnitude == 0
+            || std::ldexp(max_magnitude, f)
+            <= std::ldexp(1.0, FIXED_POINT_BITS);
+    }
+
+    std::array<Vector3<Int256>, 8> to_fixed_point(
+        const Eigen::Vector3d& x0,
+        const Eigen::Vector3d& x1,
+        const Eigen::Vector3d& x2,
+        const Eigen::Vector3d& x3,
+        const Eigen::Vector3d& x4,
+        const Eigen::Vector3d& x5,
+        const Eigen::Vector3d& x6,
+        const Eigen::Vector3d& x7)
+    {
+        const Eigen::Vector3d* x[8] = { &x0, &x1, &x2, &x3,
+                                        &x4, &x5, &x6, &x7 };
+        int f;
+        if (!fixed_point_exponent(x, f)) {
+            throw "input exceeds the fixed-point bit budget";
+        }
+
+        std::array<Vector3<Int256>, 8> v;
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 3; j++) {
+                v[i][j] = Int256(int64_t(std::ldexp((*x[i])[j], f)));
+            }
+        }
+        return v;
+    }
+
+} // namespace
+
+bool fits_fixed_point_budget(const Eigen::Matrix<double, 8, 3>& query)
+{
+    Eigen::Vector3d points[8];
+    const Eigen::Vector3d* x[8];
+    for (int i = 0; i < 8; i++) {
+        points[i] = query.row(i);
+        x[i] = &points[i];
+    }
+    int f;
+    return fixed_point_exponent(x, f);
+}
+
+Eigen::Matrix<double, 8, 3>
+quantize_to_fixed_point(const Eigen::Matrix<double, 8, 3>& query)
+{
+    if (fits_fixed_point_budget(query)) {
+        return query;
+    }
+    // The finest grid 2⁻ᶠ on which the largest magnitude m rounds to at most
+    // 2ᴮ units: m·2ᶠ < 2ᴮ for f = B - e with m < 2ᵉ.
+    int e;
+    std::frexp(query.array().abs().maxCoeff(), &e);
+    const double scale = std::ldexp(1.0, FIXED_POINT_BITS - e);
+    return ((query * scale).array().round() / scale).matrix();
+}
+
+bool vertexFaceCCD_fixed_point(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end)
+{
+    return vertexFaceRootParity(to_fixed_point(
+        vertex_start, face_vertex0_start, face_vertex1_start,
+        face_vertex2_start, vertex_end, face_vertex0_end, face_vertex1_end,
+        face_vertex2_end));
+}
+
+bool edgeEdgeCCD_fixed_point(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end)
+{
+    return edgeEdgeRootParity(to_fixed_point(
+        edge0_vertex0_start, edge0_vertex1_start, edge1_vertex0_start,
+        edge1_vertex1_start, edge0_vertex0_end, edge0_vertex1_end,
+        edge1_vertex0_end, edge1_vertex1_end));
+}
+
+} // namespace root_parity
+} // namespace ccd
@@ -0,0 +1,67 @@
+/// @brief Exact root parity CCD on fixed-point coordinates
+
+#pragma once
+
+#include <Eigen/Core>
+
+namespace ccd {
+namespace root_parity {
+
+/// Bit budget of the fixed-point methods: every coordinate, written as an
+/// integer multiple q·2⁻ᶠ of a common grid spacing, must have |q| ≤ 2⁴⁰.
+/// Queries with a wider range of magnitudes do not fit (e.g., a 2⁻⁴⁰ grid
+/// beyond [-1, 1]); see quantize_to_fixed_point.
+static const int FIXED_POINT_BITS = 40;
+
+/// Whether the fixed-point methods accept a query: its coordinates are finite
+/// and fit the bit budget on their common grid. Check it before calling them
+/// to avoid the exception.
+/// @param query  The eight points in the argument order of the CCD functions.
+bool fits_fixed_point_budget(const Eigen::Matrix<double, 8, 3>& query);
+
+/// Round a finite query to the finest dyadic grid on which it fits the bit
+/// budget (unchanged if it already fits). Rounding may change the answer.
+Eigen::Matrix<double, 8, 3>
+quantize_to_fixed_point(const Eigen::Matrix<double, 8, 3>& query);
+
+/**
+ * @brief Exact root parity vertex-face CCD in 256-bit integer arithmetic.
+ *
+ * The coordinates of the query are mapped to integers on the coarsest dyadic
+ * grid 2⁻ᶠℤ containing all of them (f ≤ 0 for integer inputs), and every
+ * predicate is evaluated exactly in integer arithmetic without GMP or heap
+ * allocations. This suits inputs quantized to a fixed grid.
+ *
+ * @throws const char* if a coordinate is not finite or the integer
+ *         coordinates exceed the bit budget FIXED_POINT_BITS (see
+ *         fits_fixed_point_budget).
+ */
+bool vertexFaceCCD_fixed_point(
+    const Eigen::Vector3d& vertex_start,
+    const Eigen::Vector3d& face_vertex0_start,
+    const Eigen::Vector3d& face_vertex1_start,
+    const Eigen::Vector3d& face_vertex2_start,
+    const Eigen::Vector3d& vertex_end,
+    const Eigen::Vector3d& face_vertex0_end,
+    const Eigen::Vector3d& face_vertex1_end,
+    const Eigen::Vector3d& face_vertex2_end);
+
+/**
+ * @brief Exact root parity edge-edge CCD in 256-bit integer arithmetic.
+ *
+ * @see vertexFaceCCD_fixed_point for the input requirements.
+ *
+ * @throws const char* if the input exceeds the bit budget.
+ */
+bool edgeEdgeCCD_fixed_point(
+    const Eigen::Vector3d& edge0_vertex0_start,
+    const Eigen::Vector3d& edge0_vertex1_start,
+    const Eigen::Vector3d& edge1_vertex0_start,
+    const Eigen::Vector3d& edge1_vertex1_start,
+    const Eigen::Vector3d& edge0_vertex0_end,
+    const Eigen::Vector3d& edge0_vertex1_end,
+    const Eigen::Vector3d& edge1_vertex0_end,
+    const Eigen::Vector3d& edge1_vertex1_end);
+
+} // namespace root_parity
+} // namespace ccd
@@ -0,0 +1,98 @@
+/// @brief Fixed-width 256-bit signed integer built on 64-bit limbs
+
+#pragma once
+
+#include <cstdint>
+
+#ifndef __SIZEOF_INT128__
+#error "Int256 requires compiler support for __int128"
+#endif
+
+namespace ccd {
+namespace root_parity {
+
+/**
+ * @brief Two's complement integer with four 64-bit limbs.
+ *
+ * Arithmetic is modulo 2²⁵⁶ and limb products use unsigned __int128, so no
+ * operation allocates or branches on the data. Results are exact as long as
+ * they fit in 255 bits plus sign; callers guarantee this by bounding their
+ * inputs (see FIXED_POINT_BITS).
+ */
+class Int256 {
+public:
+    Int256(int64_t a = 0)
+    {
+        w[0] = uint64_t(a);
+        w[1] = w[2] = w[3] = a < 0 ? ~uint64_t(0) : 0;
+    }
+
+    friend Int256 operator+(const Int256& a, const Int256& b)
+    {
+        Int256 r;
+        uint64_t carry = 0;
+        for (int i = 0; i < 4; i++) {
+            const uint128 sum = uint128(a.w[i]) + b.w[i] + carry;
+            r.w[i] = uint64_t(sum);
+            carry = uint64_t(sum >> 64);
+        }
+        return r;
+    }
+
+    friend Int256 operator-(const Int256& a)
+    {
+        Int256 r;
+        uint64_t carry = 1;
+        for (int i = 0; i < 4; i++) {
+            const uint128 sum = uint128(~a.w[i]) + carry;
+            r.w[i] = uint64_t(sum);
+            carry = uint64_t(sum >> 64);
+        }
+        return r;
+    }
+
+    friend Int256 operator-(const Int256& a, const Int256& b)
+    {
+        Int256 r;
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; i++) {
+            const uint128 diff = uint128(a.w[i]) - b.w[i] - borrow;
+            r.w[i] = uint64_t(diff);
+            borrow = uint64_t(diff >> 64) & 1;
+        }
+        return r;
+    }
+
+    /// Product modulo 2²⁵⁶; only the limb products below 2²⁵⁶ are formed.
+    friend Int256 operator*(const Int256& a, const Int256& b)
+    {
+        Int256 r;
+        r.w[0] = r.w[1] = r.w[2] = r.w[3] = 0;
+        for (int i = 0; i < 4; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; i + j < 4; j++) {
+                const uint128 p =
+                    uint128(a.w[i]) * b.w[j] + r.w[i + j] + carry;
+                r.w[i + j] = uint64_t(p);
+                carry = uint64_t(p >> 64);
+            }
+        }
+        return r;
+    }
+
+    friend int sign(const Int256& x)
+    {
+        if (int64_t(x.w[3]) < 0) {
+            return -1;
+        }
+        return (x.w[0] | x.w[1] | x.w[2] | x.w[3]) != 0;
+    }
+
+private:
+    __extension__ typedef unsigned __int128 uint128;
+
+    uint64_t w[4]; ///< Least significant limb first
+};
+
+} // namespace root_parity
+} // namespace ccd
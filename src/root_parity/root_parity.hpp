@@ -0,0 +1,353 @@
+/// @brief Root parity CCD of [Brochu et al. 2012] templated on the number type
+
+#pragma once
+
+#include <array>
+
+namespace ccd {
+namespace root_parity {
+
+/**
+ * The collision function F maps the parameter domain Ω (a prism for
+ * vertex-face and a cube for edge-edge) to R³, and the primitives collide iff
+ * the origin is in F(Ω). The image of every face of ∂Ω is either a triangle
+ * or a bilinear patch. Casting a ray from the origin, the parity of its
+ * crossings with F(∂Ω) is the parity of the number of roots in Ω.
+ *
+ * A bilinear patch with corners a, b, c, d (in cyclic order) and the
+ * triangles (a, b, c) and (a, c, d) bound a region inside the tetrahedron
+ * abcd. Crossings of the patch therefore have the parity of crossings of the
+ * two triangles, flipped if the origin is inside that region. Inside the
+ * tetrahedron, the region is where the implicit function of the patch
+ *     φ(p) = [p,a,b,c][p,a,c,d] - [p,a,b,d][p,b,c,d]
+ * is negative. With the split (a, b, d), (b, c, d), it is where φ is positive.
+ *
+ * Every decision is the sign of a polynomial in the corner coordinates of
+ * degree at most six. T must support +, -, *, construction from int, and a
+ * sign(T) overload; the answer is exact when these are. Touching (the origin
+ * lying on F(∂Ω)) counts as a collision. Rays hitting an edge or vertex of a
+ * triangle are rejected and the next direction is tried.
+ */
+
+template <typename T> using Vector3 = std::array<T, 3>;
+
+template <typename T> inline int sign(const T& x)
+{
+    return (T(0) < x) - (x < T(0));
+}
+
+template <typename T>
+Vector3<T> operator-(const Vector3<T>& a, const Vector3<T>& b)
+{
+    return { { a[0] - b[0], a[1] - b[1], a[2] - b[2] } };
+}
+
+template <typename T>
+Vector3<T> operator+(const Vector3<T>& a, const Vector3<T>& b)
+{
+    return { { a[0] + b[0], a[1] + b[1], a[2] + b[2] } };
+}
+
+template <typename T> Vector3<T> cross(const Vector3<T>& a, const Vector3<T>& b)
+{
+    return { { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+               a[0] * b[1] - a[1] * b[0] } };
+}
+
+template <typename T> T dot(const Vector3<T>& a, const Vector3<T>& b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/// Determinant [a, b, c] = a · (b × c), the orientation of (0, a, b, c).
+template <typename T>
+T det(const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c)
+{
+    return dot(a, cross(b, c));
+}
+
+template <typename T> bool is_zero(const Vector3<T>& a)
+{
+    return sign(a[0]) == 0 && sign(a[1]) == 0 && sign(a[2]) == 0;
+}
+
+/// Is the origin on the closed segment pq?
+template <typename T>
+bool origin_on_segment(const Vector3<T>& p, const Vector3<T>& q)
+{
+    return is_zero(cross(p, q)) && sign(dot(p, q)) <= 0;
+}
+
+/// Is the origin inside the closed triangle pqr? Assumes [p, q, r] = 0.
+template <typename T>
+bool origin_in_coplanar_triangle(
+    const Vector3<T>& p, const Vector3<T>& q, const Vector3<T>& r)
+{
+    const Vector3<T> pq = cross(p, q), qr = cross(q, r), rp = cross(r, p);
+    const Vector3<T> n = pq + qr + rp;
+    if (is_zero(n)) {
+        // Degenerate triangle
+        return origin_on_segment(p, q) || origin_on_segment(q, r)
+            || origin_on_segment(r, p);
+    }
+    const int s0 = sign(dot(n, pq)), s1 = sign(dot(n, qr)),
+              s2 = sign(dot(n, rp));
+    return !((s0 > 0 || s1 > 0 || s2 > 0) && (s0 < 0 || s1 < 0 || s2 < 0));
+}
+
+/// Ray directions tried in order until one is generic. They are small
+/// integers (below 2¹⁴) so that integer number types represent them exactly.
+static const int NUM_RAY_DIRECTIONS = 8;
+static const int RAY_DIRECTIONS[NUM_RAY_DIRECTIONS][3] = {
+    { 8147, 9058, 1270 },
+    { -9134, 6324, 975 },
+    { 2785, -5469, 9575 },
+    { 9649, 1576, -9706 },
+    { -9572, -4854, 8003 },
+    { 1419, 4218, -9157 },
+    { -7922, 9595, 6557 },
+    { 357, -8491, -9340 },
+};
+
+/// Accumulates the faces of F(∂Ω) and counts ray crossings. The corners are
+/// referenced, not copied, and must outlive this object.
+template <typename T> class RootParity {
+public:
+    RootParity()
+        : num_triangles(0)
+        , inside_parity(false)
+        , on_boundary(false)
+    {
+    }
+
+    /// Is the origin on one of the faces added so far?
+    bool origin_on_boundary() const { return on_boundary; }
+
+    /// Add a triangular face (p, q, r).
+    void
+    add_triangle(const Vector3<T>& p, const Vector3<T>& q, const Vector3<T>& r)
+    {
+        const int side = sign(det(p, q, r));
+        if (side == 0 && origin_in_coplanar_triangle(p, q, r)) {
+            on_boundary = true;
+        }
+        push_triangle(p, q, r, side);
+    }
+
+    /// Add a bilinear patch face with corners (a, b, c, d) in cyclic order.
+    void add_bilinear_patch(
+        const Vector3<T>& a,
+        const Vector3<T>& b,
+        const Vector3<T>& c,
+        const Vector3<T>& d)
+    {
+        const T abc = det(a, b, c), acd = det(a, c, d), abd = det(a, b, d),
+                bcd = det(b, c, d);
+        const int s_abc = sign(abc), s_acd = sign(acd), s_abd = sign(abd),
+                  s_bcd = sign(bcd);
+        // [a,b,c,d] in terms of the determinants with the origin
+        const int s_volume = sign(bcd - acd + abd - abc);
+
+        if (s_volume == 0) {
+            // Planar patch: the two splits cover the same region mod 2.
+            if (s_abc == 0 && s_acd == 0 && s_abd == 0 && s_bcd == 0
+                && (origin_in_coplanar_triangle(a, b, c)
+                    || origin_in_coplanar_triangle(a, c, d)
+                    || origin_in_coplanar_triangle(a, b, d)
+                    || origin_in_coplanar_triangle(b, c, d))) {
+                // Conservative: the convex hull contains the patch.
+                on_boundary = true;
+            }
+            push_triangle(a, b, c, s_abc);
+            push_triangle(a, c, d, s_acd);
+            return;
+        }
+
+        // Barycentric coordinates of the origin in the tetrahedron abcd
+        const bool in_tetrahedron = s_bcd * s_volume >= 0
+            && -s_acd * s_volume >= 0 && s_abd * s_volume >= 0
+            && -s_abc * s_volume >= 0;
+        if (!in_tetrahedron) {
+            push_triangle(a, b, c, s_abc);
+            push_triangle(a, c, d, s_acd);
+            return;
+        }
+
+        const int s_phi = sign(abc * acd - abd * bcd);
+        if (s_phi == 0) {
+            // The patch is exactly the zero set of φ inside the tetrahedron.
+            on_boundary = true;
+            return;
+        }
+        if (s_abc != 0 && s_acd != 0) {
+            push_triangle(a, b, c, s_abc);
+            push_triangle(a, c, d, s_acd);
+            inside_parity ^= s_phi < 0;
+        } else {
+            // The origin is on a face of the first split, so it is not on
+            // (a, b, d) or (b, c, d) unless it is on an edge of the patch.
+            push_triangle(a, b, d, s_abd);
+            push_triangle(b, c, d, s_bcd);
+            inside_parity ^= s_phi > 0;
+        }
+    }
+
+    /**
+     * @brief Parity of the number of crossings of F(∂Ω) by a ray.
+     *
+     * Assumes the origin is not on the boundary.
+     *
+     * @throws const char* if every ray direction is degenerate.
+     */
+    bool parity() const
+    {
+        for (int i = 0; i < NUM_RAY_DIRECTIONS; i++) {
+            const Vector3<T> dir = { { T(RAY_DIRECTIONS[i][0]),
+                                       T(RAY_DIRECTIONS[i][1]),
+                                       T(RAY_DIRECTIONS[i][2]) } };
+            bool parity = inside_parity;
+            bool is_generic = true;
+            for (int j = 0; j < num_triangles && is_generic; j++) {
+                switch (ray_crosses_triangle(dir, triangles[j])) {
+                case HIT:
+                    parity = !parity;
+                    break;
+                case MISS:
+                    break;
+                case DEGENERATE:
+                    is_generic = false;
+                    break;
+                }
+            }
+            if (is_generic) {
+                return parity;
+            }
+        }
+        throw "no generic ray direction found";
+    }
+
+private:
+    enum RayIntersection { MISS, HIT, DEGENERATE };
+
+    struct Triangle {
+        const Vector3<T>*p, *q, *r;
+        int side; ///< sign of [p, q, r]
+    };
+
+    // A vertex-face domain has 2 + 3 × 2 and an edge-edge one 6 × 2.
+    static const int MAX_TRIANGLES = 12;
+    std::array<Triangle, MAX_TRIANGLES> triangles;
+    int num_triangles;
+    bool inside_parity;
+    bool on_boundary;
+
+    void push_triangle(
+        const Vector3<T>& p, const Vector3<T>& q, const Vector3<T>& r, int side)
+    {
+        if (side == 0 && is_zero(cross(p, q) + cross(q, r) + cross(r, p))) {
+            // A zero-area triangle is never crossed by a generic ray.
+            return;
+        }
+        if (num_triangles >= MAX_TRIANGLES) {
+            throw "too many root parity faces";
+        }
+        Triangle& t = triangles[num_triangles++];
+        t.p = &p;
+        t.q = &q;
+        t.r = &r;
+        t.side = side;
+    }
+
+    // Does the ray {s·dir : s > 0} cross the triangle? The line through the
+    // origin hits the triangle iff [dir,p,q], [dir,q,r], and [dir,r,p] agree
+    // in sign; their sum is n·dir for the normal n, and the hit is in front
+    // of the origin iff n·dir has the sign of [p,q,r].
+    static RayIntersection
+    ray_crosses_triangle(const Vector3<T>& dir, const Triangle& t)
+    {
+        const int s0 = sign(det(dir, *t.p, *t.q)),
+                  s1 = sign(det(dir, *t.q, *t.r)),
+                  s2 = sign(det(dir, *t.r, *t.p));
+        const bool any_positive = s0 > 0 || s1 > 0 || s2 > 0;
+        const bool any_negative = s0 < 0 || s1 < 0 || s2 < 0;
+        if (any_positive && any_negative) {
+            return MISS;
+        }
+        if (!any_positive && !any_negative) {
+            // The ray is parallel to the triangle. It misses unless it lies in
+            // the triangle's plane.
+            return t.side == 0 ? DEGENERATE : MISS;
+        }
+        const int s_normal = any_positive ? 1 : -1;
+        if (t.side == 0) {
+            // The line only meets the plane at the origin, which is not in
+            // the triangle.
+            return MISS;
+        }
+        if (s_normal != t.side) {
+            return MISS; // behind the origin
+        }
+        return s0 != 0 && s1 != 0 && s2 != 0 ? HIT : DEGENERATE;
+    }
+};
+
+/**
+ * @brief Root parity vertex-face CCD.
+ *
+ * @param[in] v  Vertex start, face vertices start, vertex end, face vertices
+ *               end (in the order of ccd::vertexFaceCCD).
+ */
+template <typename T>
+bool vertexFaceRootParity(const std::array<Vector3<T>, 8>& v)
+{
+    // F(t, k) = x(t) - f_k(t) at the vertices of the prism
+    Vector3<T> F[2][3];
+    for (int t = 0; t < 2; t++) {
+        for (int k = 0; k < 3; k++) {
+            F[t][k] = v[4 * t] - v[4 * t + k + 1];
+        }
+    }
+
+    RootParity<T> rp;
+    rp.add_triangle(F[0][0], F[0][1], F[0][2]);
+    rp.add_triangle(F[1][0], F[1][1], F[1][2]);
+    for (int k = 0; k < 3 && !rp.origin_on_boundary(); k++) {
+        const int l = (k + 1) % 3;
+        rp.add_bilinear_patch(F[0][k], F[0][l], F[1][l], F[1][k]);
+    }
+    return rp.origin_on_boundary() || rp.parity();
+}
+
+/**
+ * @brief Root parity edge-edge CCD.
+ *
+ * @param[in] v  Edge vertices at the start followed by the edge vertices at
+ *               the end (in the order of ccd::edgeEdgeCCD).
+ */
+template <typename T>
+bool edgeEdgeRootParity(const std::array<Vector3<T>, 8>& v)
+{
+    // F(t, u, w) = a_u(t) - b_w(t) at the vertices of the cube
+    Vector3<T> F[2][2][2];
+    for (int t = 0; t < 2; t++) {
+        for (int u = 0; u < 2; u++) {
+            for (int w = 0; w < 2; w++) {
+                F[t][u][w] = v[4 * t + u] - v[4 * t + 2 + w];
+            }
+        }
+    }
+
+    RootParity<T> rp;
+    for (int i = 0; i < 2 && !rp.origin_on_boundary(); i++) {
+        // F is affine in (u, w), so the faces t = 0, 1 are parallelograms
+        // (F₀₀ + F₁₁ = F₁₀ + F₀₁ exactly) and split into two triangles.
+        rp.add_triangle(F[i][0][0], F[i][1][0], F[i][1][1]);
+        rp.add_triangle(F[i][0][0], F[i][1][1], F[i][0][1]);
+        rp.add_bilinear_patch(F[0][i][0], F[0][i][1], F[1][i][1], F[1][i][0]);
+        rp.add_bilinear_patch(F[0][0][i], F[0][1][i], F[1][1][i], F[1][0][i]);
+    }
+    return rp.origin_on_boundary() || rp.parity();
+}
+
+} // namespace root_parity
+} // namespace ccd
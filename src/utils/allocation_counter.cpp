@@ -0,0 +1,277 @@
+#include "allocation_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <gmp.h>
+
+#if defined(__linux__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// With glibc, malloc and co. are replaced (forwarding to glibc's own), which
+// counts every allocation of the program, including those of the shared
+// libraries. Elsewhere, operator new and GMP's memory functions are. Either
+// way, they are replaced in every run, and only test a flag (a relaxed
+// atomic load) until start_counting_allocations().
+#if defined(__GLIBC__)
+#define CCD_WRAPPER_REPLACE_MALLOC 1
+#include <unistd.h>
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+#else
+#define CCD_WRAPPER_REPLACE_MALLOC 0
+#endif
+
+namespace ccd {
+
+namespace {
+    std::atomic<bool> is_counting(false);
+    thread_local AllocationCounts counts; // zero-initialized
+
+    size_t usable_size(void* p)
+    {
+#if defined(__linux__)
+        return malloc_usable_size(p);
+#elif defined(__APPLE__)
+        return malloc_size(p);
+#elif defined(_WIN32)
+        return _msize(p);
+#else
+        return 0;
+#endif
+    }
+
+    void count_allocation(void* p)
+    {
+        if (p != nullptr && is_counting.load(std::memory_order_relaxed)) {
+            const size_t size = usable_size(p);
+            counts.num_allocations++;
+            counts.bytes += size;
+            counts.live_bytes += int64_t(size);
+            counts.peak_live_bytes
+                = std::max(counts.peak_live_bytes, counts.live_bytes);
+        }
+    }
+
+    void count_free(void* p)
+    {
+        if (p != nullptr && is_counting.load(std::memory_order_relaxed)) {
+            counts.live_bytes -= int64_t(usable_size(p));
+        }
+    }
+
+#if !CCD_WRAPPER_REPLACE_MALLOC
+    void* counted_malloc(size_t size)
+    {
+        void* p = std::malloc(size);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        count_allocation(p);
+        return p;
+    }
+
+    // GMP's memory functions, which must not throw through GMP's C frames:
+    // like GMP's own, they abort when out of memory.
+    void* gmp_allocate(size_t size)
+    {
+        void* p = std::malloc(size);
+        if (p == nullptr) {
+            std::abort();
+        }
+        count_allocation(p);
+        return p;
+    }
+
+    void* gmp_reallocate(void* p, size_t, size_t new_size)
+    {
+        count_free(p);
+        p = std::realloc(p, new_size);
+        if (p == nullptr) {
+            std::abort();
+        }
+        count_allocation(p);
+        return p;
+    }
+
+    void gmp_free(void* p, size_t)
+    {
+        count_free(p);
+        std::free(p);
+    }
+#endif
+} // namespace
+
+void start_counting_allocations()
+{
+#if !CCD_WRAPPER_REPLACE_MALLOC
+    mp_set_memory_functions(gmp_allocate, gmp_reallocate, gmp_free);
+#endif
+    is_counting.store(true);
+}
+
+bool is_counting_allocations() { return is_counting.load(); }
+
+AllocationCounts& thread_allocation_counts() { return counts; }
+
+} // namespace ccd
+
+#if CCD_WRAPPER_REPLACE_MALLOC
+
+// operator new, GMP, and the methods all allocate through these.
+extern "C" {
+
+void* malloc(size_t size) noexcept
+{
+    void* p = __libc_malloc(size);
+    ccd::count_allocation(p);
+    return p;
+}
+
+void* calloc(size_t num, size_t size) noexcept
+{
+    void* p = __libc_calloc(num, size);
+    ccd::count_allocation(p);
+    return p;
+}
+
+void* realloc(void* p, size_t size) noexcept
+{
+    if (!ccd::is_counting.load(std::memory_order_relaxed)) {
+        return __libc_realloc(p, size);
+    }
+    // On failure, p is left allocated.
+    const size_t old_size = p != nullptr ? ccd::usable_size(p) : 0;
+    void* q = __libc_realloc(p, size);
+    if (q != nullptr || size == 0) {
+        ccd::counts.live_bytes -= int64_t(old_size);
+        ccd::count_allocation(q);
+    }
+    return q;
+}
+
+void free(void* p) noexcept
+{
+    ccd::count_free(p);
+    __libc_free(p);
+}
+
+// Aligned allocations are freed by free(), so they must be counted too: all
+// those glibc's "Replacing malloc" lists.
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    void* p = __libc_memalign(alignment, size);
+    ccd::count_allocation(p);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    // Like glibc 2.38, unlike memalign, reject alignments that are not
+    // powers of two.
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return memalign(alignment, size);
+}
+
+void* valloc(size_t size) noexcept
+{
+    return memalign(size_t(sysconf(_SC_PAGESIZE)), size);
+}
+
+void* pvalloc(size_t size) noexcept
+{
+    // The size rounded up to whole pages, at least one
+    const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+    if (size > SIZE_MAX - page_size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    const size_t rounded_size
+        = std::max((size + page_size - 1) & ~(page_size - 1), page_size);
+    return memalign(page_size, rounded_size);
+}
+
+int posix_memalign(void** p, size_t alignment, size_t size) noexcept
+{
+    if (alignment % sizeof(void*) != 0
+        || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    *p = memalign(alignment, size);
+    return *p != nullptr ? 0 : ENOMEM;
+}
+
+} // extern "C"
+
+#else
+
+void* operator new(std::size_t size)
+{
+    return ccd::counted_malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return ccd::counted_malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return ccd::counted_malloc(size == 0 ? 1 : size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return ccd::counted_malloc(size == 0 ? 1 : size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    ccd::count_free(p);
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    ccd::count_free(p);
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    ccd::count_free(p);
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    ccd::count_free(p);
+    std::free(p);
+}
+
+#endif
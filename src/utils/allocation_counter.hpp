@@ -0,0 +1,37 @@
+/// @brief Counting of the heap allocations of each thread
+///
+/// Linking allocation_counter.cpp replaces malloc, calloc, realloc, free, and
+/// the aligned allocations (memalign, aligned_alloc, posix_memalign, valloc,
+/// pvalloc) of the program with glibc (forwarding to glibc's), so every
+/// allocation is counted, including Eigen's and those of shared libraries.
+/// Elsewhere, it replaces the global operator new and delete, and GMP is
+/// counted through its memory functions. The replacements are in every run;
+/// until start_counting_allocations() they only test a flag with a relaxed
+/// atomic load, which adds about 2ns to a malloc and free pair.
+
+#pragma once
+
+#include <cstdint>
+
+namespace ccd {
+
+/// Allocations of a thread while counting (zero-initialized, so the
+/// allocator can use it before the thread's constructors ran).
+struct AllocationCounts {
+    uint64_t num_allocations;
+    uint64_t bytes;          ///< allocated in total (usable sizes)
+    int64_t live_bytes;      ///< allocated minus freed by this thread
+    int64_t peak_live_bytes; ///< largest live_bytes (reset by the caller)
+};
+
+/// Count the allocations (see above) from now on, in every thread. Sizes are
+/// those of the allocator (e.g., malloc_usable_size), or 0 where it does not
+/// report them.
+void start_counting_allocations();
+
+bool is_counting_allocations();
+
+/// Counts of the calling thread.
+AllocationCounts& thread_allocation_counts();
+
+} // namespace ccd
@@ -0,0 +1,463 @@
+#include "benchmark_report.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace ccd {
+
+namespace {
+    // NaN (e.g., latency of no queries) is not valid JSON.
+    nlohmann::json number(double x)
+    {
+        return std::isfinite(x) ? nlohmann::json(x) : nlohmann::json();
+    }
+
+    double number(const nlohmann::json& x)
+    {
+        return x.is_number() ? x.get<double>() : NAN;
+    }
+
+    nlohmann::json latency_to_json(const LatencySummary& latency)
+    {
+        return {
+            { "min", number(latency.min) },
+            { "p50", number(latency.p50) },
+            { "p90", number(latency.p90) },
+            { "p99", number(latency.p99) },
+            { "p99.9", number(latency.p999) },
+            { "max", number(latency.max) },
+        };
+    }
+
+    LatencySummary latency_from_json(const nlohmann::json& json)
+    {
+        LatencySummary latency;
+        latency.min = number(json.at("min"));
+        latency.p50 = number(json.at("p50"));
+        latency.p90 = number(json.at("p90"));
+        latency.p99 = number(json.at("p99"));
+        latency.p999 = number(json.at("p99.9"));
+        latency.max = number(json.at("max"));
+        return latency;
+    }
+
+    /// Non-empty buckets as [bucket, count] pairs
+    nlohmann::json histogram_to_json(const LatencyHistogram& histogram)
+    {
+        nlohmann::json json = nlohmann::json::array();
+        for (size_t b = 0; b < histogram.num_buckets(); b++) {
+            if (histogram.bucket_count(b) > 0) {
+                json.push_back({ b, histogram.bucket_count(b) });
+            }
+        }
+        return json;
+    }
+
+    LatencyHistogram histogram_from_json(
+        const nlohmann::json& json, const LatencySummary& latency)
+    {
+        std::vector<uint64_t> counts;
+        for (const nlohmann::json& bucket : json) {
+            const size_t b = bucket.at(0).get<size_t>();
+            if (b >= counts.size()) {
+                counts.resize(b + 1, 0);
+            }
+            counts[b] += bucket.at(1).get<uint64_t>();
+        }
+        return LatencyHistogram::from_buckets(counts, latency.min, latency.max);
+    }
+
+    /// Combine x and y, averages over n_x and n_y queries.
+    double merge_average(double x, long n_x, double y, long n_y)
+    {
+        if (n_x == 0 || std::isnan(x)) {
+            return y;
+        }
+        if (n_y == 0 || std::isnan(y)) {
+            return x;
+        }
+        return (x * n_x + y * n_y) / (n_x + n_y);
+    }
+
+    std::string csv_number(double x)
+    {
+        return std::isnan(x) ? "" : fmt::format("{}", x);
+    }
+} // namespace
+
+LatencySummary summarize_latency(const LatencyHistogram& latency)
+{
+    LatencySummary summary;
+    if (latency.size() > 0) {
+        summary.min = latency.min();
+        summary.p50 = latency.percentile(0.5);
+        summary.p90 = latency.percentile(0.9);
+        summary.p99 = latency.percentile(0.99);
+        summary.p999 = latency.percentile(0.999);
+        summary.max = latency.max();
+    }
+    return summary;
+}
+
+std::string cpu_model_name()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos && colon + 2 <= line.size()) {
+                return line.substr(colon + 2);
+            }
+        }
+    }
+    return "unknown";
+}
+
+void write_report_json(const BenchmarkReport& report, const std::string& path)
+{
+    nlohmann::json json;
+    for (const auto& entry : report.fingerprint) {
+        json["fingerprint"][entry.first] = entry.second;
+    }
+    json["peak_rss"] = report.peak_rss;
+    json["records"] = nlohmann::json::array();
+    for (const BenchmarkRecord& record : report.records) {
+        nlohmann::json counters;
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            counters[perf_event_names[e]] = number(record.counters[e]);
+        }
+        counters["ipc"] = number(
+            record.counters[INSTRUCTIONS] / record.counters[CYCLES]);
+        json["records"].push_back({
+            { "method", record.method },
+            { "dataset", record.dataset },
+            { "query_type", record.query_type },
+            { "scene", record.scene },
+            { "num_queries", record.num_queries },
+            { "num_positives", record.num_positives },
+            { "num_false_positives", record.num_false_positives },
+            { "num_false_negatives", record.num_false_negatives },
+            { "num_skipped", record.num_skipped },
+            { "average_time_ns", number(record.average_time) },
+            { "latency_ns", latency_to_json(record.latency) },
+            { "warm_latency_ns", latency_to_json(record.warm_latency) },
+            { "counters_per_query", counters },
+            { "allocations_per_query",
+              {
+                  { "allocations", number(record.allocations) },
+                  { "bytes", number(record.allocated_bytes) },
+              } },
+            { "peak_live_bytes", number(record.peak_live_bytes) },
+            { "latency_histogram",
+              histogram_to_json(record.latency_histogram) },
+            { "warm_latency_histogram",
+              histogram_to_json(record.warm_latency_histogram) },
+        });
+    }
+
+    if (!report.scaling.empty()) {
+        json["scaling"] = nlohmann::json::array();
+    }
+    for (const ScalingRecord& record : report.scaling) {
+        json["scaling"].push_back({
+            { "method", record.method },
+            { "num_threads", record.num_threads },
+            { "num_queries", record.num_queries },
+            { "wall_time_s", number(record.wall_time) },
+            { "throughput", number(record.throughput) },
+            { "speedup", number(record.speedup) },
+            { "efficiency", number(record.efficiency) },
+            { "imbalance", number(record.imbalance) },
+            { "average_time_ns", number(record.average_time) },
+        });
+    }
+
+    std::ofstream file(path);
+    file << json.dump(2) << std::endl;
+    if (!file) {
+        throw "unable to write the JSON report";
+    }
+}
+
+void write_report_csv(const BenchmarkReport& report, const std::string& path)
+{
+    std::ofstream file(path);
+    for (const auto& entry : report.fingerprint) {
+        file << "# " << entry.first << ": " << entry.second << "\n";
+    }
+    file << "# peak_rss: " << report.peak_rss << "\n";
+    if (report.records.empty() && !report.scaling.empty()) {
+        file << "method,num_threads,num_queries,wall_time_s,throughput,"
+                "speedup,efficiency,imbalance,average_time_ns\n";
+        for (const ScalingRecord& r : report.scaling) {
+            file << fmt::format(
+                "{},{},{},{},{},{},{},{},{}\n", r.method, r.num_threads,
+                r.num_queries, r.wall_time, r.throughput, r.speedup,
+                r.efficiency, r.imbalance, r.average_time);
+        }
+        if (!file) {
+            throw "unable to write the CSV report";
+        }
+        return;
+    }
+    file << "method,dataset,query_type,scene,num_queries,num_positives,"
+            "num_false_positives,num_false_negatives,num_skipped,"
+            "average_time_ns,"
+            "min_ns,p50_ns,p90_ns,p99_ns,p99.9_ns,max_ns,warm_min_ns,"
+            "warm_p50_ns,warm_p90_ns,warm_p99_ns,warm_p99.9_ns,warm_max_ns";
+    for (const char* name : perf_event_names) {
+        file << "," << name;
+    }
+    file << ",allocations,allocated_bytes,peak_live_bytes\n";
+    for (const BenchmarkRecord& r : report.records) {
+        file << fmt::format(
+            "{},{},{},{},{},{},{},{},{},{}", r.method, r.dataset,
+            r.query_type, r.scene, r.num_queries, r.num_positives,
+            r.num_false_positives, r.num_false_negatives, r.num_skipped,
+            r.average_time);
+        for (const LatencySummary& latency : { r.latency, r.warm_latency }) {
+            for (double time : { latency.min, latency.p50, latency.p90,
+                                 latency.p99, latency.p999, latency.max }) {
+                file << "," << csv_number(time);
+            }
+        }
+        for (double count : r.counters) {
+            file << "," << csv_number(count);
+        }
+        for (double count :
+             { r.allocations, r.allocated_bytes, r.peak_live_bytes }) {
+            file << "," << csv_number(count);
+        }
+        file << "\n";
+    }
+    if (!file) {
+        throw "unable to write the CSV report";
+    }
+}
+
+BenchmarkReport read_report_json(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw "unable to open the report";
+    }
+
+    BenchmarkReport report;
+    try {
+        const nlohmann::json json = nlohmann::json::parse(file);
+        if (json.contains("fingerprint")) {
+            for (const auto& entry : json["fingerprint"].items()) {
+                report.fingerprint.emplace_back(
+                    entry.key(), entry.value().get<std::string>());
+            }
+        }
+        report.peak_rss = json.value("peak_rss", uint64_t(0));
+        for (const nlohmann::json& r : json.at("records")) {
+            BenchmarkRecord record;
+            record.method = r.at("method").get<std::string>();
+            record.dataset = r.at("dataset").get<std::string>();
+            record.query_type = r.at("query_type").get<std::string>();
+            record.scene = r.at("scene").get<std::string>();
+            record.num_queries = r.at("num_queries").get<long>();
+            record.num_positives = r.at("num_positives").get<long>();
+            record.num_false_positives
+                = r.at("num_false_positives").get<long>();
+            record.num_false_negatives
+                = r.at("num_false_negatives").get<long>();
+            record.num_skipped = r.value("num_skipped", 0L);
+            record.average_time = number(r.at("average_time_ns"));
+            record.latency = latency_from_json(r.at("latency_ns"));
+            if (r.contains("warm_latency_ns")) {
+                record.warm_latency = latency_from_json(r["warm_latency_ns"]);
+            }
+            if (r.contains("latency_histogram")) {
+                record.latency_histogram = histogram_from_json(
+                    r["latency_histogram"], record.latency);
+            }
+            if (r.contains("warm_latency_histogram")) {
+                record.warm_latency_histogram = histogram_from_json(
+                    r["warm_latency_histogram"], record.warm_latency);
+            }
+            if (r.contains("counters_per_query")) {
+                const nlohmann::json& counters = r["counters_per_query"];
+                for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+                    if (counters.contains(perf_event_names[e])) {
+                        record.counters[e]
+                            = number(counters[perf_event_names[e]]);
+                    }
+                }
+            }
+            if (r.contains("allocations_per_query")) {
+                const nlohmann::json& allocations = r["allocations_per_query"];
+                record.allocations = number(allocations.at("allocations"));
+                record.allocated_bytes = number(allocations.at("bytes"));
+            }
+            if (r.contains("peak_live_bytes")) {
+                record.peak_live_bytes = number(r["peak_live_bytes"]);
+            }
+            report.records.push_back(record);
+        }
+        if (json.contains("scaling")) {
+            for (const nlohmann::json& r : json["scaling"]) {
+                ScalingRecord record;
+                record.method = r.at("method").get<std::string>();
+                record.num_threads = r.at("num_threads").get<int>();
+                record.num_queries = r.at("num_queries").get<long>();
+                record.wall_time = number(r.at("wall_time_s"));
+                record.throughput = number(r.at("throughput"));
+                record.speedup = number(r.at("speedup"));
+                record.efficiency = number(r.at("efficiency"));
+                record.imbalance = number(r.at("imbalance"));
+                record.average_time = number(r.at("average_time_ns"));
+                report.scaling.push_back(record);
+            }
+        }
+    } catch (const nlohmann::json::exception&) {
+        throw "invalid JSON report";
+    }
+    return report;
+}
+
+BenchmarkReport merge_reports(const std::vector<BenchmarkReport>& shards)
+{
+    // Options that differ between the shards of a run
+    const auto is_shard_specific = [](const std::string& key) {
+        return key == "shard" || key == "date" || key == "timer_overhead_ns";
+    };
+    const auto run_fingerprint = [&](const BenchmarkReport& report) {
+        std::vector<std::pair<std::string, std::string>> fingerprint;
+        for (const auto& entry : report.fingerprint) {
+            if (!is_shard_specific(entry.first)) {
+                fingerprint.push_back(entry);
+            }
+        }
+        return fingerprint;
+    };
+
+    BenchmarkReport merged;
+    std::map<std::string, size_t> record_indices;
+    for (const BenchmarkReport& shard : shards) {
+        if (!shard.scaling.empty()) {
+            throw "scaling reports cannot be merged";
+        }
+        if (&shard == &shards.front()) {
+            for (const auto& entry : shard.fingerprint) {
+                if (entry.first != "shard") {
+                    merged.fingerprint.push_back(entry);
+                }
+            }
+        } else if (run_fingerprint(shard) != run_fingerprint(shards.front())) {
+            throw "the reports are not of the same benchmark";
+        }
+        merged.peak_rss = std::max(merged.peak_rss, shard.peak_rss);
+
+        for (const BenchmarkRecord& record : shard.records) {
+            const auto index = record_indices.find(record.key());
+            if (index == record_indices.end()) {
+                record_indices[record.key()] = merged.records.size();
+                merged.records.push_back(record);
+                continue;
+            }
+            BenchmarkRecord& total = merged.records[index->second];
+            total.average_time = merge_average(
+                total.average_time, total.num_queries, record.average_time,
+                record.num_queries);
+            for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+                total.counters[e] = merge_average(
+                    total.counters[e], total.num_queries, record.counters[e],
+                    record.num_queries);
+            }
+            total.allocations = merge_average(
+                total.allocations, total.num_queries, record.allocations,
+                record.num_queries);
+            total.allocated_bytes = merge_average(
+                total.allocated_bytes, total.num_queries,
+                record.allocated_bytes, record.num_queries);
+            if (std::isnan(total.peak_live_bytes)
+                || record.peak_live_bytes > total.peak_live_bytes) {
+                total.peak_live_bytes = record.peak_live_bytes;
+            }
+            total.num_queries += record.num_queries;
+            total.num_positives += record.num_positives;
+            total.num_false_positives += record.num_false_positives;
+            total.num_false_negatives += record.num_false_negatives;
+            total.num_skipped += record.num_skipped;
+            total.latency_histogram.merge(record.latency_histogram);
+            total.warm_latency_histogram.merge(record.warm_latency_histogram);
+            total.latency = summarize_latency(total.latency_histogram);
+            total.warm_latency
+                = summarize_latency(total.warm_latency_histogram);
+        }
+    }
+
+    // Order as in a single run: by method, dataset, and query type as first
+    // seen, then the scene "all" and the scenes by name.
+    std::map<std::string, size_t> group_order;
+    for (const BenchmarkRecord& record : merged.records) {
+        group_order.emplace(
+            record.method + " " + record.dataset + "/" + record.query_type,
+            group_order.size());
+    }
+    const auto order = [&](const BenchmarkRecord& record) {
+        return std::make_tuple(
+            group_order.at(
+                record.method + " " + record.dataset + "/"
+                + record.query_type),
+            record.scene != "all", record.scene);
+    };
+    std::stable_sort(
+        merged.records.begin(), merged.records.end(),
+        [&](const BenchmarkRecord& a, const BenchmarkRecord& b) {
+            return order(a) < order(b);
+        });
+    return merged;
+}
+
+std::vector<std::string> find_regressions(
+    const BenchmarkReport& baseline,
+    const BenchmarkReport& current,
+    double threshold)
+{
+    std::map<std::string, const BenchmarkRecord*> baseline_records;
+    for (const BenchmarkRecord& record : baseline.records) {
+        baseline_records[record.key()] = &record;
+    }
+
+    std::vector<std::string> regressions;
+    for (const BenchmarkRecord& record : current.records) {
+        const auto it = baseline_records.find(record.key());
+        if (it == baseline_records.end()) {
+            continue;
+        }
+        const BenchmarkRecord& base = *it->second;
+
+        if (record.num_false_negatives > base.num_false_negatives) {
+            regressions.push_back(fmt::format(
+                "{}: false negatives {} -> {}", record.key(),
+                base.num_false_negatives, record.num_false_negatives));
+        }
+        if (base.average_time > 0
+            && record.average_time > (1 + threshold) * base.average_time) {
+            regressions.push_back(fmt::format(
+                "{}: average time {:.0f}ns -> {:.0f}ns (+{:.1f}%)",
+                record.key(), base.average_time, record.average_time,
+                100 * (record.average_time / base.average_time - 1)));
+        }
+        // Counts of the same queries only differ by rounding.
+        if (record.allocations > base.allocations + 1e-9) {
+            regressions.push_back(fmt::format(
+                "{}: heap allocations per query {:.3f} -> {:.3f}",
+                record.key(), base.allocations, record.allocations));
+        }
+    }
+    return regressions;
+}
+
+} // namespace ccd
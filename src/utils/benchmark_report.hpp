@@ -0,0 +1,123 @@
+/// @brief Machine-readable benchmark results and regression checks
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <utils/latency_histogram.hpp>
+#include <utils/perf_counters.hpp>
+
+namespace ccd {
+
+/// Percentiles of the time per query in ns (NaN without queries)
+struct LatencySummary {
+    double min = NAN, p50 = NAN, p90 = NAN, p99 = NAN, p999 = NAN, max = NAN;
+};
+
+LatencySummary summarize_latency(const LatencyHistogram& latency);
+
+/// Results of one method on the queries of one scene and query type.
+struct BenchmarkRecord {
+    std::string method;
+    std::string dataset;    ///< "handcrafted" or "simulation"
+    std::string query_type; ///< "vertex-face" or "edge-edge"
+    std::string scene;
+
+    long num_queries = 0;
+    long num_positives = 0;
+    long num_false_positives = 0;
+    long num_false_negatives = 0;
+    long num_skipped = 0; ///< queries the method cannot take, not run
+
+    double average_time = 0; ///< ns per query
+    LatencySummary latency;
+    /// Same queries run again right away (only with --cache cold/shuffled)
+    LatencySummary warm_latency;
+    /// What the latencies were summarized from, so the reports of shards
+    /// can be merged (JSON only)
+    LatencyHistogram latency_histogram, warm_latency_histogram;
+
+    /// Hardware counters per query (NaN if not counted)
+    double counters[NUM_PERF_EVENTS] = { NAN, NAN, NAN, NAN, NAN };
+
+    /// Heap allocations and their bytes per query, and the most bytes a
+    /// query had allocated at once (NaN if not counted)
+    double allocations = NAN, allocated_bytes = NAN, peak_live_bytes = NAN;
+
+    /// Identifies the same record in another report.
+    std::string key() const
+    {
+        return method + " " + dataset + "/" + query_type + "/" + scene;
+    }
+};
+
+/// Throughput of one method with one number of threads (--scaling).
+struct ScalingRecord {
+    std::string method;
+    int num_threads = 0;
+    long num_queries = 0;
+    double wall_time = 0;    ///< s
+    double throughput = 0;   ///< queries per second
+    double speedup = 0;      ///< relative to the fewest threads
+    double efficiency = 0;   ///< speedup per added thread
+    double imbalance = 0;    ///< busiest thread's CCD time over the mean - 1
+    double average_time = 0; ///< ns per query
+};
+
+/// Everything written by --output and read by --compare.
+struct BenchmarkReport {
+    /// Build, machine, and options the results were measured with
+    std::vector<std::pair<std::string, std::string>> fingerprint;
+    uint64_t peak_rss = 0; ///< bytes
+    std::vector<BenchmarkRecord> records;
+    std::vector<ScalingRecord> scaling;
+};
+
+/// Model name of the CPU, or "unknown" if it cannot be determined.
+std::string cpu_model_name();
+
+/// Write a report as JSON; throws a const char* on failure.
+void write_report_json(const BenchmarkReport& report, const std::string& path);
+
+/// Write the records (or else the scaling records) as CSV with the
+/// fingerprint as leading # comments; throws a const char* on failure.
+void write_report_csv(const BenchmarkReport& report, const std::string& path);
+
+/// Read a report written by write_report_json; throws a const char* on
+/// failure.
+BenchmarkReport read_report_json(const std::string& path);
+
+/**
+ * @brief Merge the reports of the shards of a run (--shard) into the report
+ * of the whole run.
+ *
+ * Records with the same key() are combined: counts are added, averages
+ * weighted by the number of queries, and the latencies summarized from the
+ * merged histograms, so they are those of a single run. The fingerprint is
+ * the first report's without the shard, and the peak memory use is the
+ * largest. Throws a const char* if the reports are not of the same
+ * benchmark or contain scaling records.
+ */
+BenchmarkReport merge_reports(const std::vector<BenchmarkReport>& shards);
+
+/**
+ * @brief Find where current regressed relative to baseline.
+ *
+ * A record regresses if its average time per query grew by more than
+ * threshold (a fraction), it has more false negatives, or it makes more
+ * heap allocations per query (if both reports counted them). Records are
+ * matched by BenchmarkRecord::key(); records missing in either report are
+ * ignored.
+ *
+ * @return A description of every regression.
+ */
+std::vector<std::string> find_regressions(
+    const BenchmarkReport& baseline,
+    const BenchmarkReport& current,
+    double threshold);
+
+} // namespace ccd
@@ -0,0 +1,100 @@
+#include "binary_queries.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace ccd {
+
+namespace {
+    const char MAGIC[8] = { 'C', 'C', 'D', 'Q', 'U', 'E', 'R', 'Y' };
+
+    // The format is little-endian and written with plain memory copies.
+    bool is_little_endian()
+    {
+        const uint32_t one = 1;
+        unsigned char first_byte;
+        std::memcpy(&first_byte, &one, 1);
+        return first_byte == 1;
+    }
+} // namespace
+
+void write_binary_queries(
+    const std::string& path,
+    const Eigen::MatrixXd& V,
+    const std::vector<bool>& results,
+    uint32_t flags)
+{
+    if (!is_little_endian()) {
+        throw "binary query files require a little-endian host";
+    }
+    if (V.rows() % 8 != 0 || V.cols() != 3 || results.size() != V.rows()) {
+        throw "invalid query matrix";
+    }
+
+    BinaryQueryHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = BINARY_QUERIES_VERSION;
+    header.flags = flags;
+    header.num_queries = V.rows() / 8;
+    header.reserved = 0;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw "unable to create file";
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (uint64_t i = 0; i < header.num_queries; i++) {
+        const Eigen::Matrix<double, 8, 3> query = V.middleRows<8>(8 * i);
+        file.write(
+            reinterpret_cast<const char*>(query.data()), sizeof(query));
+    }
+
+    std::vector<uint64_t> bits((header.num_queries + 63) / 64, 0);
+    for (uint64_t i = 0; i < header.num_queries; i++) {
+        bits[i / 64] |= uint64_t(results[8 * i]) << (i % 64);
+    }
+    file.write(
+        reinterpret_cast<const char*>(bits.data()),
+        bits.size() * sizeof(uint64_t));
+
+    if (!file) {
+        throw "unable to write file";
+    }
+}
+
+BinaryQueries::BinaryQueries(const std::string& path)
+    : file(path)
+{
+    if (!is_little_endian()) {
+        throw "binary query files require a little-endian host";
+    }
+
+    BinaryQueryHeader header;
+    if (file.size() < sizeof(header)) {
+        throw "file is too small for a binary query header";
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw "not a binary query file";
+    }
+    if (header.version != BINARY_QUERIES_VERSION) {
+        throw "unsupported binary query file version";
+    }
+
+    num_queries = header.num_queries;
+    header_flags = header.flags;
+    const size_t vertices_size = 24 * sizeof(double) * num_queries;
+    const size_t results_size = (num_queries + 63) / 64 * sizeof(uint64_t);
+    if (file.size() != sizeof(header) + vertices_size + results_size) {
+        throw "binary query file has the wrong size";
+    }
+
+    // The header is 32 bytes and mappings are page aligned, so the data is
+    // aligned for doubles and 64-bit words.
+    vertices = reinterpret_cast<const double*>(file.data() + sizeof(header));
+    results = reinterpret_cast<const uint64_t*>(
+        file.data() + sizeof(header) + vertices_size);
+}
+
+} // namespace ccd
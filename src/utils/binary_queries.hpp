@@ -0,0 +1,87 @@
+/// @brief Compact binary format for CCD benchmark queries
+///
+/// Layout (little-endian):
+///   1. BinaryQueryHeader (32 bytes)
+///   2. num_queries × 24 doubles: each query as an 8×3 Eigen matrix in Eigen's
+///      (column-major) storage order
+///   3. ⌈num_queries / 64⌉ uint64 words of ground truth: the result of query i
+///      is bit i % 64 of word i / 64
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <utils/mapped_file.hpp>
+
+namespace ccd {
+
+/// File extension of binary query files (e.g., data.csv → data.ccdq).
+static const char* const BINARY_QUERIES_EXTENSION = ".ccdq";
+
+struct BinaryQueryHeader {
+    char magic[8];        ///< "CCDQUERY"
+    uint32_t version;     ///< BINARY_QUERIES_VERSION
+    uint32_t flags;       ///< BinaryQueryFlags
+    uint64_t num_queries; ///< Number of 8×3 queries
+    uint64_t reserved;    ///< Zero
+};
+static_assert(sizeof(BinaryQueryHeader) == 32, "unexpected header padding");
+
+static const uint32_t BINARY_QUERIES_VERSION = 1;
+
+enum BinaryQueryFlags : uint32_t {
+    /// Every coordinate equals its rational in the source CSV exactly.
+    EXACT_COORDINATES = 1,
+};
+
+/**
+ * @brief Write queries in the binary format.
+ *
+ * @param V        8n×3 vertices as returned by read_rational_csv.
+ * @param results  Ground truth per vertex row as returned by
+ *                 read_rational_csv (only every eighth entry is used).
+ * @param flags    BinaryQueryFlags describing the data.
+ */
+void write_binary_queries(
+    const std::string& path,
+    const Eigen::MatrixXd& V,
+    const std::vector<bool>& results,
+    uint32_t flags);
+
+/**
+ * @brief Queries of a binary file, read in place from a memory map.
+ *
+ * Opening validates the header and size but copies nothing. Throws a
+ * const char* if the file is not a valid binary query file.
+ */
+class BinaryQueries {
+public:
+    explicit BinaryQueries(const std::string& path);
+
+    size_t size() const { return num_queries; }
+
+    uint32_t flags() const { return header_flags; }
+
+    /// The i-th query (vertex rows as in the CSV files).
+    Eigen::Map<const Eigen::Matrix<double, 8, 3>> query(size_t i) const
+    {
+        return Eigen::Map<const Eigen::Matrix<double, 8, 3>>(
+            vertices + 24 * i);
+    }
+
+    /// Ground truth of the i-th query.
+    bool result(size_t i) const { return (results[i / 64] >> (i % 64)) & 1; }
+
+private:
+    MappedFile file;
+    const double* vertices;
+    const uint64_t* results;
+    size_t num_queries;
+    uint32_t header_flags;
+};
+
+} // namespace ccd
@@ -0,0 +1,92 @@
+#include "cache_eviction.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define CCD_WRAPPER_FLUSH_LINE(p) _mm_clflush(p)
+#define CCD_WRAPPER_FLUSH_FENCE() _mm_mfence()
+#elif defined(__aarch64__)
+#define CCD_WRAPPER_FLUSH_LINE(p)                                              \
+    asm volatile("dc civac, %0" ::"r"(p) : "memory")
+#define CCD_WRAPPER_FLUSH_FENCE() asm volatile("dsb ish" ::: "memory")
+#else
+// Only the buffer evicts the data.
+#define CCD_WRAPPER_FLUSH_LINE(p)
+#define CCD_WRAPPER_FLUSH_FENCE()
+#endif
+
+namespace ccd {
+
+namespace {
+    const size_t CACHE_LINE_SIZE = 64;
+} // namespace
+
+size_t cpu_cache_size(int level)
+{
+    size_t size = 0;
+    for (int index = 0;; index++) {
+        const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index"
+            + std::to_string(index) + "/";
+        std::ifstream level_file(dir + "level");
+        if (!level_file) {
+            break;
+        }
+        int cache_level = 0;
+        std::string type, size_str;
+        level_file >> cache_level;
+        std::ifstream(dir + "type") >> type;
+        std::ifstream(dir + "size") >> size_str;
+        if (cache_level != level || type == "Instruction") {
+            continue;
+        }
+        // e.g., "2048K"
+        size_t cache_size = 0;
+        try {
+            cache_size = std::stoul(size_str);
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (!size_str.empty() && size_str.back() == 'K') {
+            cache_size <<= 10;
+        } else if (!size_str.empty() && size_str.back() == 'M') {
+            cache_size <<= 20;
+        }
+        size = std::max(size, cache_size);
+    }
+    return size;
+}
+
+CacheEvictor::CacheEvictor(size_t num_bytes)
+{
+    if (num_bytes == 0) {
+        num_bytes = 2 * cpu_cache_size(2);
+    }
+    if (num_bytes == 0) {
+        num_bytes = size_t(1) << 20;
+    }
+    // Written once so every page is mapped.
+    buffer.assign(num_bytes, 1);
+}
+
+void CacheEvictor::evict(const void* data, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < buffer.size(); i += CACHE_LINE_SIZE) {
+        sum += uint64_t(buffer[i]);
+    }
+    sink = sum;
+
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data)
+        & ~uintptr_t(CACHE_LINE_SIZE - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+    for (uintptr_t p = begin; p < end; p += CACHE_LINE_SIZE) {
+        CCD_WRAPPER_FLUSH_LINE(reinterpret_cast<const void*>(p));
+    }
+    CCD_WRAPPER_FLUSH_FENCE();
+}
+
+} // namespace ccd
@@ -0,0 +1,38 @@
+/// @brief Evicting data from the CPU caches between timed regions
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ccd {
+
+/// Size in bytes of the largest data or unified cache at a level of the
+/// first CPU, or 0 if unknown.
+size_t cpu_cache_size(int level);
+
+/**
+ * @brief Makes the next access to some data miss the caches.
+ *
+ * Reading a buffer twice the size of the level-2 cache replaces what the
+ * core cached privately (e.g., the stack and tables of the last query),
+ * and the lines of the data itself are flushed from every level so they
+ * come from memory. The shared last-level cache is not swept, which would
+ * take milliseconds per query.
+ */
+class CacheEvictor {
+public:
+    /// @param num_bytes  Size of the buffer to read, or 0 for twice the
+    ///                   level-2 cache (1 MiB if unknown).
+    explicit CacheEvictor(size_t num_bytes = 0);
+
+    /// Evict the private caches and flush [data, data + size).
+    void evict(const void* data, size_t size);
+
+private:
+    std::vector<char> buffer;
+    volatile uint64_t sink = 0; ///< keeps the reads from being optimized out
+};
+
+} // namespace ccd
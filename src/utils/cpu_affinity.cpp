@@ -0,0 +1,128 @@
+#include "cpu_affinity.hpp"
+
+#if defined(__linux__)
+#define CCD_WRAPPER_HAS_AFFINITY 1
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+#else
+#define CCD_WRAPPER_HAS_AFFINITY 0
+#endif
+
+namespace ccd {
+
+#if CCD_WRAPPER_HAS_AFFINITY
+
+namespace {
+    /// Parse a Linux CPU list such as "0-3,8-11".
+    std::vector<int> parse_cpu_list(const std::string& list)
+    {
+        std::vector<int> cpus;
+        std::stringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ',')) {
+            int first, last;
+            const int n = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (n < 1) {
+                continue;
+            }
+            if (n == 1) {
+                last = first;
+            }
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    /// Read a topology id of a CPU, or -1 if it cannot be read.
+    int read_topology_id(int cpu, const char* name)
+    {
+        std::ifstream file(
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/"
+            + name);
+        int id = -1;
+        file >> id;
+        return id;
+    }
+} // namespace
+
+std::vector<int> cpu_pinning_order(bool numa_aware)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return {};
+    }
+
+    std::map<int, int> node_of_cpu;
+    {
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string nodes;
+        std::getline(online, nodes);
+        for (int node : parse_cpu_list(nodes)) {
+            std::ifstream cpulist(
+                "/sys/devices/system/node/node" + std::to_string(node)
+                + "/cpulist");
+            std::string cpus;
+            std::getline(cpulist, cpus);
+            for (int cpu : parse_cpu_list(cpus)) {
+                node_of_cpu[cpu] = node;
+            }
+        }
+    }
+
+    // Sorted by (SMT sibling index, rank in its node, node, CPU)
+    std::vector<std::tuple<int, int, int, int>> cpus;
+    std::map<std::pair<int, int>, int> num_siblings; // per (package, core)
+    std::map<std::pair<int, int>, int> num_ranked;   // per (node, sibling)
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        const std::pair<int, int> core(
+            read_topology_id(cpu, "physical_package_id"),
+            read_topology_id(cpu, "core_id"));
+        // Unknown topology: every CPU is its own core.
+        const int sibling = core.second < 0 ? 0 : num_siblings[core]++;
+        const int node = numa_aware && node_of_cpu.count(cpu)
+            ? node_of_cpu[cpu]
+            : 0;
+        const int rank = numa_aware ? num_ranked[{ node, sibling }]++ : 0;
+        cpus.emplace_back(sibling, rank, node, cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+
+    std::vector<int> order;
+    for (const auto& cpu : cpus) {
+        order.push_back(std::get<3>(cpu));
+    }
+    return order;
+}
+
+bool pin_thread_to_cpu(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#else
+
+std::vector<int> cpu_pinning_order(bool) { return {}; }
+
+bool pin_thread_to_cpu(int) { return false; }
+
+#endif
+
+} // namespace ccd
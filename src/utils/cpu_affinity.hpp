@@ -0,0 +1,24 @@
+/// @brief Pinning threads to CPUs for reproducible parallel timings
+
+#pragma once
+
+#include <vector>
+
+namespace ccd {
+
+/**
+ * @brief CPUs this process may run on, in the order to pin threads to.
+ *
+ * One hardware thread of every physical core comes before any second SMT
+ * sibling, so n threads use n cores while there are enough. With
+ * numa_aware, consecutive threads alternate between NUMA nodes, so every
+ * node's memory controller and caches take an equal share. Empty if the
+ * CPUs cannot be determined (e.g., not on Linux).
+ */
+std::vector<int> cpu_pinning_order(bool numa_aware);
+
+/// Pin the calling thread to a CPU.
+/// @return False if pinning is unsupported or failed.
+bool pin_thread_to_cpu(int cpu);
+
+} // namespace ccd
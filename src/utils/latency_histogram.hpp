@@ -0,0 +1,132 @@
+/// @brief Histogram of latencies with logarithmic buckets
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ccd {
+
+/**
+ * @brief Counts non-negative latencies in buckets of bounded relative width.
+ *
+ * Every power of two is split into SUB_BUCKETS linear buckets (as in HDR
+ * histograms), so a percentile is reported within 1/SUB_BUCKETS (6.25%) of
+ * its true value, while the minimum and maximum are exact. Values below one
+ * (e.g., nanosecond) share the first bucket. Buckets are allocated up to
+ * the largest value seen.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+
+    void add(double x)
+    {
+        x = std::max(x, 0.0);
+        const size_t b = bucket(x);
+        if (b >= counts.size()) {
+            counts.resize(b + 1, 0);
+        }
+        counts[b]++;
+        num_samples++;
+        min_value = std::min(min_value, x);
+        max_value = std::max(max_value, x);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        if (other.counts.size() > counts.size()) {
+            counts.resize(other.counts.size(), 0);
+        }
+        for (size_t b = 0; b < other.counts.size(); b++) {
+            counts[b] += other.counts[b];
+        }
+        num_samples += other.num_samples;
+        min_value = std::min(min_value, other.min_value);
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    uint64_t size() const { return num_samples; }
+    double min() const { return num_samples ? min_value : NAN; }
+    double max() const { return num_samples ? max_value : NAN; }
+
+    /// Smallest bucket bound such that a fraction p of the values are at
+    /// most it, clamped to [min, max].
+    double percentile(double p) const
+    {
+        if (num_samples == 0) {
+            return NAN;
+        }
+        const uint64_t rank = std::min(
+            num_samples,
+            std::max(uint64_t(1), uint64_t(std::ceil(p * num_samples))));
+        uint64_t cumulative = 0;
+        size_t b = 0;
+        for (; b < counts.size(); b++) {
+            cumulative += counts[b];
+            if (cumulative >= rank) {
+                break;
+            }
+        }
+        return std::min(std::max(upper_bound(b), min_value), max_value);
+    }
+
+    size_t num_buckets() const { return counts.size(); }
+
+    /// Rebuild a histogram from its bucket counts and its minimum and
+    /// maximum (e.g., as written to a report).
+    static LatencyHistogram from_buckets(
+        const std::vector<uint64_t>& counts, double min, double max)
+    {
+        LatencyHistogram histogram;
+        histogram.counts = counts;
+        for (uint64_t count : counts) {
+            histogram.num_samples += count;
+        }
+        if (histogram.num_samples > 0) {
+            histogram.min_value = min;
+            histogram.max_value = max;
+        }
+        return histogram;
+    }
+
+    /// Number of values in bucket b.
+    uint64_t bucket_count(size_t b) const
+    {
+        return b < counts.size() ? counts[b] : 0;
+    }
+
+    /// Largest value of bucket b.
+    static double upper_bound(size_t b)
+    {
+        if (b == 0) {
+            return 1;
+        }
+        const size_t e = (b - 1) / SUB_BUCKETS, s = (b - 1) % SUB_BUCKETS;
+        return std::ldexp(1 + double(s + 1) / SUB_BUCKETS, int(e));
+    }
+
+private:
+    /// Bucket 0 is [0, 1); then x = (1 + s/SUB_BUCKETS)·2ᵉ is in bucket
+    /// 1 + e·SUB_BUCKETS + s.
+    static size_t bucket(double x)
+    {
+        if (!(x >= 1)) {
+            return 0;
+        }
+        int e;
+        const double m = std::frexp(x, &e); // x = m·2ᵉ, m ∈ [0.5, 1)
+        const int s = int((2 * m - 1) * SUB_BUCKETS);
+        return 1 + size_t(e - 1) * SUB_BUCKETS + size_t(s);
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t num_samples = 0;
+    double min_value = std::numeric_limits<double>::infinity();
+    double max_value = -std::numeric_limits<double>::infinity();
+};
+
+} // namespace ccd
@@ -0,0 +1,71 @@
+#include "mapped_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CCD_WRAPPER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CCD_WRAPPER_HAS_MMAP 0
+#include <fstream>
+#endif
+
+namespace ccd {
+
+#if CCD_WRAPPER_HAS_MMAP
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw "unable to open file";
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw "unable to stat file";
+    }
+    num_bytes = size_t(st.st_size);
+    if (num_bytes > 0) {
+        void* p = mmap(nullptr, num_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw "unable to map file";
+        }
+        // Queries are read front to back.
+        madvise(p, num_bytes, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(p);
+    }
+    close(fd); // the mapping keeps the file open
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes != nullptr) {
+        munmap(const_cast<char*>(bytes), num_bytes);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw "unable to open file";
+    }
+    buffer.resize(size_t(file.tellg()));
+    file.seekg(0);
+    if (!file.read(buffer.data(), buffer.size())) {
+        throw "unable to read file";
+    }
+    bytes = buffer.data();
+    num_bytes = buffer.size();
+}
+
+MappedFile::~MappedFile() { }
+
+#endif
+
+} // namespace ccd
@@ -0,0 +1,35 @@
+/// @brief Read-only view of a whole file, memory-mapped where available
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ccd {
+
+/**
+ * @brief Maps a file into memory for reading in place.
+ *
+ * On POSIX systems the file is mapped with mmap, so opening it costs no
+ * reads and pages are loaded lazily. Elsewhere the file is read into a
+ * buffer. Throws a const char* if the file cannot be opened.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return num_bytes; }
+
+private:
+    const char* bytes = nullptr;
+    size_t num_bytes = 0;
+    std::vector<char> buffer; ///< File contents if mmap is unavailable
+};
+
+} // namespace ccd
@@ -0,0 +1,91 @@
+#include "parameter_sweep.hpp"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace ccd {
+
+std::vector<std::pair<double, long>> sweep_settings(
+    const std::vector<double>& tolerances, const std::vector<long>& max_iters)
+{
+    std::vector<std::pair<double, long>> settings = { {
+        *std::min_element(tolerances.begin(), tolerances.end()),
+        *std::max_element(max_iters.begin(), max_iters.end()) } };
+    for (double tolerance : tolerances) {
+        for (long max_iter : max_iters) {
+            if (std::make_pair(tolerance, max_iter) != settings[0]) {
+                settings.emplace_back(tolerance, max_iter);
+            }
+        }
+    }
+    return settings;
+}
+
+void measure_toi_error(
+    const std::vector<double>& tois,
+    const std::vector<double>& reference_tois,
+    SweepPoint& point)
+{
+    point.mean_toi_error = point.max_toi_error = 0;
+    long num_tois = 0;
+    for (size_t i = 0; i < std::min(tois.size(), reference_tois.size());
+         i++) {
+        if (!std::isnan(tois[i]) && !std::isnan(reference_tois[i])) {
+            const double error = std::abs(tois[i] - reference_tois[i]);
+            point.mean_toi_error += error;
+            point.max_toi_error = std::max(point.max_toi_error, error);
+            num_tois++;
+        }
+    }
+    if (num_tois > 0) {
+        point.mean_toi_error /= num_tois;
+    }
+}
+
+bool dominates(const SweepPoint& a, const SweepPoint& b)
+{
+    const double time_a = a.average_time, time_b = b.average_time;
+    const long fp_a = a.num_false_positives, fp_b = b.num_false_positives,
+               fn_a = a.num_false_negatives, fn_b = b.num_false_negatives;
+    const double toi_a = a.max_toi_error, toi_b = b.max_toi_error;
+    return time_a <= time_b && fp_a <= fp_b && fn_a <= fn_b && toi_a <= toi_b
+        && (time_a < time_b || fp_a < fp_b || fn_a < fn_b || toi_a < toi_b);
+}
+
+std::vector<bool> pareto_frontier(const std::vector<SweepPoint>& points)
+{
+    std::vector<bool> is_on_frontier(points.size(), true);
+    for (size_t i = 0; i < points.size(); i++) {
+        for (const SweepPoint& other : points) {
+            if (dominates(other, points[i])) {
+                is_on_frontier[i] = false;
+                break;
+            }
+        }
+    }
+    return is_on_frontier;
+}
+
+void print_sweep(const std::vector<SweepPoint>& points)
+{
+    fmt::print(
+        "{:>10} {:>9} {:>10} {:>9} {:>10} {:>10} {:>10} {:>8} {:>8} {:>9} "
+        "{:>9} {:>7}\n",
+        "tolerance", "max_iter", "min_sep", "queries", "average", "p50", "p99",
+        "FP", "FN", "toi_mean", "toi_max", "pareto");
+    const std::vector<bool> is_on_frontier = pareto_frontier(points);
+    for (size_t i = 0; i < points.size(); i++) {
+        const SweepPoint& point = points[i];
+        fmt::print(
+            "{:>10g} {:>9d} {:>10g} {:>9d} {:>8.0f}ns {:>8.0f}ns {:>8.0f}ns "
+            "{:>8d} {:>8d} {:>9.2e} {:>9.2e} {:>7}\n",
+            point.tolerance, point.max_iter, point.minimum_separation,
+            point.num_queries, point.average_time, point.p50, point.p99,
+            point.num_false_positives, point.num_false_negatives,
+            point.mean_toi_error, point.max_toi_error,
+            is_on_frontier[i] ? "*" : "");
+    }
+}
+
+} // namespace ccd
@@ -0,0 +1,53 @@
+/// @brief Points of the parameter sweep of the minimum separation methods
+/// (--sweep-*) and their Pareto frontier
+
+#pragma once
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace ccd {
+
+/// A point of the sweep grid and what a method measured with it.
+struct SweepPoint {
+    double tolerance = 0;
+    long max_iter = 0;
+    double minimum_separation = 0;
+
+    long num_queries = 0;
+    double average_time = NAN, p50 = NAN, p99 = NAN; ///< ns per query
+    long num_false_positives = 0, num_false_negatives = 0;
+    /// Mean and maximum of |toi - toi_ref| over the queries where both this
+    /// point and the reference compute a time of impact (see
+    /// measure_toi_error)
+    double mean_toi_error = 0, max_toi_error = 0;
+};
+
+/// The (tolerance, max_iter) settings of the grid for one minimum
+/// separation, the tightest (smallest tolerance and largest max_iter) first
+/// as the reference of the others.
+std::vector<std::pair<double, long>> sweep_settings(
+    const std::vector<double>& tolerances, const std::vector<long>& max_iters);
+
+/// Set the time of impact error of a point from the times of impact of its
+/// queries and those of the reference, in the same order (NaN where the
+/// method does not compute one).
+void measure_toi_error(
+    const std::vector<double>& tois,
+    const std::vector<double>& reference_tois,
+    SweepPoint& point);
+
+/// Whether a point is at least as fast and accurate (false positives, false
+/// negatives, and maximum time of impact error) as another and better in
+/// one of them.
+bool dominates(const SweepPoint& a, const SweepPoint& b);
+
+/// Whether each point is on the Pareto frontier: no other point dominates
+/// it.
+std::vector<bool> pareto_frontier(const std::vector<SweepPoint>& points);
+
+/// Print the points as a table, marking the Pareto frontier with *.
+void print_sweep(const std::vector<SweepPoint>& points);
+
+} // namespace ccd
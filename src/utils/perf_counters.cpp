@@ -0,0 +1,151 @@
+#include "perf_counters.hpp"
+
+#if defined(__linux__)
+#define CCD_WRAPPER_HAS_PERF_EVENT 1
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#else
+#define CCD_WRAPPER_HAS_PERF_EVENT 0
+#endif
+
+namespace ccd {
+
+#if CCD_WRAPPER_HAS_PERF_EVENT
+
+namespace {
+    uint64_t cache_miss_config(uint64_t cache)
+    {
+        return cache | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8)
+            | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+
+    int open_event(uint32_t type, uint64_t config, int group_fd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1; // allowed with perf_event_paranoid ≤ 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(
+            SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+            PERF_FLAG_FD_CLOEXEC));
+    }
+
+    std::string describe_error(int error)
+    {
+        if (error == EACCES || error == EPERM) {
+            int paranoid = -1;
+            std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> paranoid;
+            return "not permitted (kernel.perf_event_paranoid = "
+                + std::to_string(paranoid) + ", needs ≤ 2)";
+        }
+        if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV) {
+            return "not supported by this CPU or virtual machine";
+        }
+        if (error == ENOSYS) {
+            return "perf_event_open is not available in this kernel";
+        }
+        return std::strerror(error);
+    }
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+    const uint32_t types[NUM_PERF_EVENTS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+    };
+    const uint64_t configs[NUM_PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        cache_miss_config(PERF_COUNT_HW_CACHE_L1D),
+        cache_miss_config(PERF_COUNT_HW_CACHE_LL),
+    };
+
+    // The first event that opens leads the group.
+    std::vector<std::pair<std::string, std::string>> errors; // reason, events
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        fds[e] = open_event(types[e], configs[e], leader);
+        slots[e] = -1;
+        if (fds[e] < 0) {
+            const std::string reason = describe_error(errno);
+            auto error = errors.begin();
+            while (error != errors.end() && error->first != reason) {
+                ++error;
+            }
+            if (error == errors.end()) {
+                errors.emplace_back(reason, perf_event_names[e]);
+            } else {
+                error->second += std::string(", ") + perf_event_names[e];
+            }
+            continue;
+        }
+        if (leader < 0) {
+            leader = fds[e];
+        }
+        slots[e] = num_slots++;
+    }
+
+    for (const auto& error : errors) {
+        error_message += (error_message.empty() ? "" : "; ") + error.second
+            + ": " + error.first;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            close(fds[e]);
+        }
+    }
+}
+
+bool PerfCounters::read(uint64_t values[NUM_PERF_EVENTS]) const
+{
+    // { nr, time_enabled, time_running, value[nr] }
+    uint64_t buffer[3 + NUM_PERF_EVENTS] = {};
+    const bool is_read = leader >= 0
+        && ::read(leader, buffer, sizeof(buffer)) > 0
+        && buffer[0] == uint64_t(num_slots);
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        values[e] = is_read && slots[e] >= 0 ? buffer[3 + slots[e]] : 0;
+    }
+    return is_read && buffer[1] == buffer[2];
+}
+
+#else
+
+PerfCounters::PerfCounters()
+{
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        fds[e] = slots[e] = -1;
+    }
+    error_message = "hardware counters are only supported on Linux";
+}
+
+PerfCounters::~PerfCounters() { }
+
+bool PerfCounters::read(uint64_t values[NUM_PERF_EVENTS]) const
+{
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        values[e] = 0;
+    }
+    return false;
+}
+
+#endif
+
+} // namespace ccd
@@ -0,0 +1,106 @@
+/// @brief Hardware performance counters of the calling thread
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace ccd {
+
+enum PerfEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_READ_MISSES,
+    LLC_READ_MISSES,
+    NUM_PERF_EVENTS
+};
+
+static const char* perf_event_names[NUM_PERF_EVENTS] = {
+    "cycles", "instructions", "branch_misses", "l1d_read_misses",
+    "llc_read_misses"
+};
+
+/**
+ * @brief User-space hardware counters of the thread that created it.
+ *
+ * On Linux the events are opened as one perf_event_open group, so they
+ * count the same instructions and are read with a single system call.
+ * Events the CPU, kernel, or permissions do not allow are left out and
+ * error() says why; elsewhere no event is available. Never throws.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool is_available(PerfEvent event) const { return slots[event] >= 0; }
+    bool is_any_available() const { return leader >= 0; }
+
+    /// Why some events are unavailable (empty if all are available).
+    const std::string& error() const { return error_message; }
+
+    /// Read the running counts (0 for unavailable events).
+    /// @return False if the counts are incomplete because the kernel
+    ///         multiplexed the counters.
+    bool read(uint64_t values[NUM_PERF_EVENTS]) const;
+
+private:
+    int leader = -1;            ///< group leader file descriptor
+    int fds[NUM_PERF_EVENTS];   ///< -1 if unavailable
+    int slots[NUM_PERF_EVENTS]; ///< position in a group read, or -1
+    int num_slots = 0;
+    std::string error_message;
+};
+
+/// Counts summed over many measured regions.
+struct PerfCounts {
+    uint64_t totals[NUM_PERF_EVENTS] = {};
+    long num_samples[NUM_PERF_EVENTS] = {}; ///< regions counted per event
+
+    /// Add the counts of a region measured with counters.
+    void add(const PerfCounters& counters, const uint64_t values[])
+    {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            if (counters.is_available(PerfEvent(e))) {
+                totals[e] += values[e];
+                num_samples[e]++;
+            }
+        }
+    }
+
+    void merge(const PerfCounts& other)
+    {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            totals[e] += other.totals[e];
+            num_samples[e] += other.num_samples[e];
+        }
+    }
+
+    bool empty() const
+    {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            if (num_samples[e] > 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Average count per region, or NaN if the event was not counted.
+    double average(PerfEvent event) const
+    {
+        return num_samples[event] > 0
+            ? double(totals[event]) / num_samples[event]
+            : NAN;
+    }
+
+    /// Instructions per cycle, or NaN if either was not counted.
+    double ipc() const { return average(INSTRUCTIONS) / average(CYCLES); }
+};
+
+} // namespace ccd
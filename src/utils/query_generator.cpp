@@ -0,0 +1,422 @@
+#include "query_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace ccd {
+
+namespace {
+
+    /// Coordinates are built as integers in units of 2^-GRID_BITS, so the
+    /// queries are exact and their ground truth follows from the construction.
+    const int GRID_BITS = 40;
+    /// Half the extent of a query before it is placed (4 in coordinates)
+    const int64_t R = int64_t(1) << (GRID_BITS + 2);
+
+    typedef Eigen::Matrix<int64_t, 3, 1> GridPoint;
+    typedef Eigen::Matrix<int64_t, 8, 3> GridQuery;
+
+    /// Builds one query with the generator's random numbers.
+    class QueryBuilder {
+    public:
+        QueryBuilder(const bool is_edge_edge, std::mt19937_64& rng)
+            : is_edge_edge(is_edge_edge)
+            , rng(rng)
+        {
+        }
+
+        /// Generate a query of the family.
+        /// @return Its ground truth.
+        bool generate(const QueryFamily family, Eigen::Matrix<double, 8, 3>& V)
+        {
+            GridQuery q;
+            QueryFamily kind = family;
+            if (family == LARGE_OFFSET) {
+                kind = QueryFamily(uniform(NEAR_TOUCHING, SLIDING));
+            }
+            bool result;
+            switch (kind) {
+            case FAR:
+                result = far(q);
+                break;
+            case NEAR_TOUCHING:
+                result = is_edge_edge ? near_touching_ee(q)
+                                      : near_touching_vf(q);
+                break;
+            case COPLANAR:
+                result = is_edge_edge ? coplanar_ee(q) : coplanar_vf(q);
+                break;
+            case PARALLEL:
+                result = is_edge_edge ? parallel_ee(q) : parallel_vf(q);
+                break;
+            default:
+                result = is_edge_edge ? sliding_ee(q) : sliding_vf(q);
+                break;
+            }
+            place(q);
+
+            if (family == LARGE_OFFSET) {
+                // An offset of 2^(e-1) to 2^e with the grid coarsened to
+                // 2^(e-52), so the sums stay below 2^53 units and are exact;
+                // the query is then about 2^-10 times the size of its offset.
+                const int e = int(uniform(12, 40));
+                for (int i = 0; i < 3; i++) {
+                    const int64_t offset = (uniform(0, 1) ? 1 : -1)
+                        * uniform(int64_t(1) << 51, int64_t(1) << 52);
+                    for (int j = 0; j < 8; j++) {
+                        V(j, i) = std::ldexp(double(q(j, i) + offset), e - 52);
+                    }
+                }
+            } else {
+                for (int j = 0; j < 8; j++) {
+                    for (int i = 0; i < 3; i++) {
+                        V(j, i) = std::ldexp(double(q(j, i)), -GRID_BITS);
+                    }
+                }
+            }
+            return result;
+        }
+
+    private:
+        int64_t uniform(const int64_t a, const int64_t b)
+        {
+            return std::uniform_int_distribution<int64_t>(a, b)(rng);
+        }
+
+        double uniform_real(const double a, const double b)
+        {
+            return std::uniform_real_distribution<double>(a, b)(rng);
+        }
+
+        /// An exact gap of 2^-40 to 2^-10.
+        int64_t gap() { return int64_t(1) << uniform(0, 30); }
+
+        GridPoint random_point(const int64_t half_extent, const int64_t z)
+        {
+            return GridPoint(
+                uniform(-half_extent, half_extent),
+                uniform(-half_extent, half_extent), z);
+        }
+
+        /// A translation of the whole query over the time step.
+        GridPoint random_translation()
+        {
+            return GridPoint(
+                uniform(-R / 4, R / 4), uniform(-R / 4, R / 4),
+                uniform(-R / 4, R / 4));
+        }
+
+        static GridPoint round(const double x, const double y, const int64_t z)
+        {
+            return GridPoint(std::llround(x), std::llround(y), z);
+        }
+
+        static double cross(const GridPoint& a, const GridPoint& b)
+        {
+            return double(a.x()) * double(b.y())
+                - double(a.y()) * double(b.x());
+        }
+
+        /// A well-shaped triangle in the plane z = 0.
+        void random_triangle(GridPoint t[3])
+        {
+            do {
+                for (int j = 0; j < 3; j++) {
+                    t[j] = random_point(R / 2, 0);
+                }
+            } while (std::abs(cross(t[1] - t[0], t[2] - t[0]))
+                     < double(R) * double(R) / 8);
+        }
+
+        /// A segment in the plane z = 0 at least R/4 long.
+        void random_segment(GridPoint& a0, GridPoint& a1)
+        {
+            do {
+                a0 = random_point(R / 2, 0);
+                a1 = random_point(R / 2, 0);
+            } while ((a1 - a0).cast<double>().norm() < R / 4);
+        }
+
+        /// A point with barycentric coordinates b in the triangle's plane.
+        static GridPoint
+        barycentric(const GridPoint t[3], const double b[3], const int64_t z)
+        {
+            double x = 0, y = 0;
+            for (int j = 0; j < 3; j++) {
+                x += b[j] * double(t[j].x());
+                y += b[j] * double(t[j].y());
+            }
+            return round(x, y, z);
+        }
+
+        /// A point at height z over the triangle, at least 1/8 of its
+        /// heights away from its edges.
+        GridPoint inside(const GridPoint t[3], const int64_t z)
+        {
+            double u[2] = { uniform_real(0, 1), uniform_real(0, 1) };
+            std::sort(u, u + 2);
+            const double b[3] = { 1.0 / 8 + 5.0 / 8 * u[0],
+                                  1.0 / 8 + 5.0 / 8 * (u[1] - u[0]),
+                                  1.0 / 8 + 5.0 / 8 * (1 - u[1]) };
+            return barycentric(t, b, z);
+        }
+
+        /// A point in the triangle's plane beyond the edge opposite vertex
+        /// k, at least 1/8 of the height away from its line.
+        GridPoint outside(const GridPoint t[3], const int k)
+        {
+            double b[3];
+            b[k] = -uniform_real(1.0 / 8, 1);
+            const double u = uniform_real(0, 1);
+            b[(k + 1) % 3] = (1 - b[k]) * u;
+            b[(k + 2) % 3] = (1 - b[k]) * (1 - u);
+            return barycentric(t, b, 0);
+        }
+
+        /// A point in the plane z = 0 on the given side of the line through a0
+        /// and a1, at least 1/8 of |a1 - a0| away from it.
+        GridPoint
+        beside(const GridPoint& a0, const GridPoint& a1, const double side)
+        {
+            const GridPoint a = a1 - a0;
+            const double s = uniform_real(-1, 2);
+            const double h = side * uniform_real(1.0 / 8, 1);
+            return round(
+                double(a0.x()) + s * double(a.x()) - h * double(a.y()),
+                double(a0.y()) + s * double(a.y()) + h * double(a.x()), 0);
+        }
+
+        /// An edge in the plane z = 0 crossing the edge (a0, a1) at its
+        /// parameter s, at least 1/8 away from both edges' ends and at an angle
+        /// of at least asin(1/4).
+        void crossing_edge(
+            const GridPoint& a0,
+            const GridPoint& a1,
+            const double s,
+            GridPoint& b0,
+            GridPoint& b1)
+        {
+            const GridPoint a = a1 - a0;
+            GridPoint w;
+            do {
+                w = random_point(R / 2, 0);
+            } while (w.cast<double>().norm() < R / 8
+                     || std::abs(cross(a, w)) < a.cast<double>().norm()
+                             * w.cast<double>().norm() / 4);
+            const double r = uniform_real(1.0 / 8, 7.0 / 8);
+            const double cx = double(a0.x()) + s * double(a.x());
+            const double cy = double(a0.y()) + s * double(a.y());
+            b0 = round(cx - r * double(w.x()), cy - r * double(w.y()), 0);
+            b1 = round(
+                cx + (1 - r) * double(w.x()), cy + (1 - r) * double(w.y()), 0);
+        }
+
+        /// The face t and the vertex (at v0, then v1) relative to it, while it
+        /// moves by d.
+        static void set_vertex_face(
+            GridQuery& q,
+            const GridPoint t[3],
+            const GridPoint& v0,
+            const GridPoint& v1,
+            const GridPoint& d)
+        {
+            q.row(0) = v0.transpose();
+            q.row(4) = (v1 + d).transpose();
+            for (int j = 0; j < 3; j++) {
+                q.row(1 + j) = t[j].transpose();
+                q.row(5 + j) = (t[j] + d).transpose();
+            }
+        }
+
+        /// The edge (a0, a1) and the edge b (at b_start, then b_end)
+        /// relative to it, while it moves by d.
+        static void set_edge_edge(
+            GridQuery& q,
+            const GridPoint& a0,
+            const GridPoint& a1,
+            const GridPoint b_start[2],
+            const GridPoint b_end[2],
+            const GridPoint& d)
+        {
+            q.row(0) = a0.transpose();
+            q.row(1) = a1.transpose();
+            q.row(4) = (a0 + d).transpose();
+            q.row(5) = (a1 + d).transpose();
+            for (int j = 0; j < 2; j++) {
+                q.row(2 + j) = b_start[j].transpose();
+                q.row(6 + j) = (b_end[j] + d).transpose();
+            }
+        }
+
+        bool far(GridQuery& q)
+        {
+            // Shift the vertex or second edge past the bounding box of the
+            // rest.
+            const int64_t shift = R + 1 + uniform(0, R);
+            for (int j = 0; j < 8; j++) {
+                q.row(j)
+                    = random_point(R / 2, uniform(-R / 2, R / 2)).transpose();
+                if (is_edge_edge ? j % 4 >= 2 : j % 4 == 0) {
+                    q(j, 0) += shift;
+                }
+            }
+            return false;
+        }
+
+        bool near_touching_vf(GridQuery& q)
+        {
+            GridPoint t[3];
+            random_triangle(t);
+            const bool is_hit = uniform(0, 1);
+            const GridPoint v0 = inside(t, uniform(R / 16, R / 2));
+            const GridPoint v1 = inside(t, is_hit ? -gap() : gap());
+            set_vertex_face(q, t, v0, v1, random_translation());
+            return is_hit;
+        }
+
+        bool coplanar_vf(GridQuery& q)
+        {
+            GridPoint t[3];
+            random_triangle(t);
+            const bool is_hit = uniform(0, 1);
+            const int k = int(uniform(0, 2));
+            const GridPoint v0 = outside(t, k);
+            const GridPoint v1 = is_hit ? inside(t, 0) : outside(t, k);
+            set_vertex_face(q, t, v0, v1, random_translation());
+            return is_hit;
+        }
+
+        bool parallel_vf(GridQuery& q)
+        {
+            GridPoint t[3];
+            random_triangle(t);
+            const int64_t z = gap();
+            set_vertex_face(
+                q, t, inside(t, z), inside(t, z), random_translation());
+            return false;
+        }
+
+        bool sliding_vf(GridQuery& q)
+        {
+            GridPoint t[3];
+            random_triangle(t);
+            set_vertex_face(
+                q, t, inside(t, 0), inside(t, 0), random_translation());
+            return true;
+        }
+
+        bool near_touching_ee(GridQuery& q)
+        {
+            GridPoint a0, a1, b_start[2], b_end[2];
+            random_segment(a0, a1);
+            crossing_edge(
+                a0, a1, uniform_real(1.0 / 8, 7.0 / 8), b_end[0], b_end[1]);
+            const bool is_hit = uniform(0, 1);
+            const int64_t z0 = uniform(R / 16, R / 2);
+            const int64_t z1 = is_hit ? -gap() : gap();
+            for (int j = 0; j < 2; j++) {
+                b_start[j] = b_end[j];
+                b_start[j].z() = z0;
+                b_end[j].z() = z1;
+            }
+            set_edge_edge(q, a0, a1, b_start, b_end, random_translation());
+            return is_hit;
+        }
+
+        bool coplanar_ee(GridQuery& q)
+        {
+            GridPoint a0, a1, b_start[2], b_end[2];
+            random_segment(a0, a1);
+            const bool is_hit = uniform(0, 1);
+            const double side = uniform(0, 1) ? 1 : -1;
+            b_start[0] = beside(a0, a1, side);
+            b_start[1] = beside(a0, a1, side);
+            if (is_hit) {
+                crossing_edge(
+                    a0, a1, uniform_real(1.0 / 8, 7.0 / 8), b_end[0], b_end[1]);
+            } else {
+                b_end[0] = beside(a0, a1, side);
+                b_end[1] = beside(a0, a1, side);
+            }
+            set_edge_edge(q, a0, a1, b_start, b_end, random_translation());
+            return is_hit;
+        }
+
+        bool parallel_ee(GridQuery& q)
+        {
+            // Edges along the x axis; the second one passes through the line of
+            // the first, overlapping it, or passes it at a gap.
+            const int64_t x0 = uniform(-R / 2, 0);
+            const int64_t x1 = uniform(x0 + R / 4, R / 2);
+            const int kind = int(uniform(0, 2)); // hit, y gap, x gap
+            int64_t bx0, bx1;
+            if (kind == 2) {
+                bx0 = x1 + gap();
+                bx1 = bx0 + uniform(R / 8, R / 2);
+            } else {
+                bx0 = uniform(x0 - R / 4, x1 - R / 8);
+                bx1 = uniform(std::max(bx0, x0) + R / 8, x1 + R / 4);
+            }
+            if (uniform(0, 1)) {
+                std::swap(bx0, bx1);
+            }
+            const int64_t y = kind == 1 ? gap() : 0;
+            const int64_t z0 = uniform(R / 16, R / 2);
+            const int64_t z1 = -uniform(R / 16, R / 2);
+            const GridPoint b_start[2] = { GridPoint(bx0, y, z0),
+                                           GridPoint(bx1, y, z0) };
+            const GridPoint b_end[2] = { GridPoint(bx0, y, z1),
+                                         GridPoint(bx1, y, z1) };
+            set_edge_edge(
+                q, GridPoint(x0, 0, 0), GridPoint(x1, 0, 0), b_start, b_end,
+                random_translation());
+            return kind == 0;
+        }
+
+        bool sliding_ee(GridQuery& q)
+        {
+            // The second edge slides along the first, crossing it throughout.
+            GridPoint a0, a1, b_start[2], b_end[2];
+            random_segment(a0, a1);
+            const double s0 = uniform_real(1.0 / 8, 7.0 / 8);
+            const double s1 = uniform_real(1.0 / 8, 7.0 / 8);
+            crossing_edge(a0, a1, s0, b_start[0], b_start[1]);
+            const GridPoint a = a1 - a0;
+            const GridPoint shift = round(
+                (s1 - s0) * double(a.x()), (s1 - s0) * double(a.y()), 0);
+            b_end[0] = b_start[0] + shift;
+            b_end[1] = b_start[1] + shift;
+            set_edge_edge(q, a0, a1, b_start, b_end, random_translation());
+            return true;
+        }
+
+        /// Permute and reflect the axes at random and translate the query.
+        void place(GridQuery& q)
+        {
+            int axes[3] = { 0, 1, 2 };
+            std::shuffle(axes, axes + 3, rng);
+            GridQuery placed;
+            for (int i = 0; i < 3; i++) {
+                const int64_t sign = uniform(0, 1) ? 1 : -1;
+                const int64_t translation = uniform(-R, R);
+                for (int j = 0; j < 8; j++) {
+                    placed(j, i) = sign * q(j, axes[i]) + translation;
+                }
+            }
+            q = placed;
+        }
+
+        bool is_edge_edge;
+        std::mt19937_64& rng;
+    };
+
+} // namespace
+
+bool QueryGenerator::generate(
+    const QueryFamily family, Eigen::Matrix<double, 8, 3>& query)
+{
+    return QueryBuilder(is_edge_edge, rng).generate(family, query);
+}
+
+} // namespace ccd
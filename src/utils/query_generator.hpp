@@ -0,0 +1,61 @@
+/// @brief Synthetic CCD queries with ground truth known by construction
+
+#pragma once
+
+#include <random>
+
+#include <Eigen/Core>
+
+namespace ccd {
+
+/// Kinds of synthetic queries
+enum QueryFamily {
+    /// Random primitives whose bounding boxes are disjoint (negative)
+    FAR,
+    /// A vertex or edge stopping just short of or just past the other
+    /// primitive (negative or positive)
+    NEAR_TOUCHING,
+    /// Everything in one plane, meeting or missing (positive or negative)
+    COPLANAR,
+    /// A vertex moving parallel to the face just above it (negative), or
+    /// parallel edges with or without overlap (positive or negative)
+    PARALLEL,
+    /// In contact over the whole time step (positive)
+    SLIDING,
+    /// One of the degenerate kinds above, far from the origin
+    LARGE_OFFSET,
+    NUM_QUERY_FAMILIES
+};
+
+static const char* query_family_names[NUM_QUERY_FAMILIES] = {
+    "far", "near-touching", "coplanar", "parallel", "sliding", "large-offset",
+};
+
+/**
+ * @brief Random queries of each family.
+ *
+ * A query is built in a local frame where the face or first edge lies in
+ * the plane z = 0 and moves by a common translation, and the margins of the
+ * construction (at least 1/8 of the primitives' size, or an exact gap of
+ * 2^-40 to 2^-10) are much larger than the rounding of points to the grid.
+ * It is then placed by an exact permutation and reflection of the axes and
+ * a translation.
+ */
+class QueryGenerator {
+public:
+    QueryGenerator(bool is_edge_edge, std::seed_seq& seed)
+        : is_edge_edge(is_edge_edge)
+        , rng(seed)
+    {
+    }
+
+    /// Generate a query of the family.
+    /// @return Its ground truth.
+    bool generate(QueryFamily family, Eigen::Matrix<double, 8, 3>& query);
+
+private:
+    bool is_edge_edge;
+    std::mt19937_64 rng;
+};
+
+} // namespace ccd
@@ -0,0 +1,201 @@
+#include "query_sampling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace ccd {
+
+namespace {
+    const double Z_95 = 1.959964; ///< two-sided 95% quantile of N(0, 1)
+
+    /// Weight of each stratum in the population; strata without samples
+    /// are left out.
+    std::vector<double>
+    stratum_weights(const std::vector<SampledStratum>& strata)
+    {
+        double population_size = 0;
+        for (const SampledStratum& stratum : strata) {
+            if (stratum.latency.size() > 0) {
+                population_size += stratum.population_size;
+            }
+        }
+        std::vector<double> weights;
+        for (const SampledStratum& stratum : strata) {
+            weights.push_back(
+                stratum.latency.size() > 0
+                    ? stratum.population_size / population_size
+                    : 0);
+        }
+        return weights;
+    }
+
+    /// Finite population correction of a stratum
+    double fpc(const SampledStratum& stratum)
+    {
+        return std::max(
+            0.0, 1 - double(stratum.latency.size()) / stratum.population_size);
+    }
+} // namespace
+
+bool glob_match(const std::string& pattern, const std::string& text)
+{
+    // Greedy matching that backtracks to the last * on a mismatch
+    const size_t none = std::string::npos;
+    size_t p = 0, t = 0, star = none, star_t = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_t = t;
+        } else if (
+            p < pattern.size()
+            && (pattern[p] == '?' || pattern[p] == text[t])) {
+            p++;
+            t++;
+        } else if (star != none) {
+            p = star + 1;
+            t = ++star_t;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+std::vector<uint64_t>
+allocate_sample(const std::vector<uint64_t>& stratum_sizes, uint64_t n)
+{
+    std::vector<uint64_t> sample(stratum_sizes.size(), 0);
+    uint64_t population_size = 0;
+    for (uint64_t size : stratum_sizes) {
+        population_size += size;
+    }
+    if (population_size == 0) {
+        return sample;
+    }
+    n = std::min(n, population_size);
+
+    uint64_t num_allocated = 0;
+    std::vector<std::pair<double, size_t>> remainders;
+    for (size_t h = 0; h < stratum_sizes.size(); h++) {
+        const double exact = double(n) * stratum_sizes[h] / population_size;
+        sample[h] = uint64_t(exact);
+        num_allocated += sample[h];
+        remainders.emplace_back(exact - sample[h], h);
+    }
+    std::stable_sort(
+        remainders.begin(), remainders.end(),
+        [](const std::pair<double, size_t>& a,
+           const std::pair<double, size_t>& b) { return a.first > b.first; });
+    for (size_t i = 0; num_allocated < n; i++, num_allocated++) {
+        sample[remainders[i].second]++;
+    }
+
+    for (size_t h = 0; h < stratum_sizes.size(); h++) {
+        sample[h]
+            = std::min(stratum_sizes[h], std::max<uint64_t>(sample[h], 2));
+    }
+    return sample;
+}
+
+Estimate estimate_mean(const std::vector<SampledStratum>& strata)
+{
+    const std::vector<double> weights = stratum_weights(strata);
+    Estimate estimate;
+    double mean = 0, variance = 0;
+    bool is_empty = true;
+    for (size_t h = 0; h < strata.size(); h++) {
+        const double n = strata[h].latency.size();
+        if (n == 0) {
+            continue;
+        }
+        is_empty = false;
+        const double stratum_mean = strata[h].sum / n;
+        const double stratum_variance = n > 1
+            ? std::max(
+                0.0,
+                (strata[h].sum_squared - n * stratum_mean * stratum_mean)
+                    / (n - 1))
+            : 0;
+        mean += weights[h] * stratum_mean;
+        variance += weights[h] * weights[h] * stratum_variance / n
+            * fpc(strata[h]);
+    }
+    if (is_empty) {
+        return estimate;
+    }
+    estimate.value = mean;
+    estimate.lower = mean - Z_95 * std::sqrt(variance);
+    estimate.upper = mean + Z_95 * std::sqrt(variance);
+    return estimate;
+}
+
+Estimate
+estimate_percentile(const std::vector<SampledStratum>& strata, double p)
+{
+    const std::vector<double> weights = stratum_weights(strata);
+    size_t num_buckets = 0;
+    double min = std::numeric_limits<double>::infinity(), max = -min;
+    for (const SampledStratum& stratum : strata) {
+        if (stratum.latency.size() > 0) {
+            num_buckets = std::max(num_buckets, stratum.latency.num_buckets());
+            min = std::min(min, stratum.latency.min());
+            max = std::max(max, stratum.latency.max());
+        }
+    }
+    Estimate estimate;
+    if (num_buckets == 0) {
+        return estimate;
+    }
+
+    // The estimated population CDF at the upper bound of every bucket
+    std::vector<std::vector<double>> stratum_cdfs(strata.size());
+    std::vector<double> cdf(num_buckets, 0);
+    for (size_t h = 0; h < strata.size(); h++) {
+        const double n = strata[h].latency.size();
+        stratum_cdfs[h].resize(num_buckets, 0);
+        double cumulative = 0;
+        for (size_t b = 0; b < num_buckets && n > 0; b++) {
+            cumulative += strata[h].latency.bucket_count(b);
+            stratum_cdfs[h][b] = cumulative / n;
+            cdf[b] += weights[h] * stratum_cdfs[h][b];
+        }
+    }
+
+    // Value at the first bucket whose CDF reaches q
+    const auto quantile = [&](double q) {
+        size_t b = 0;
+        while (b + 1 < num_buckets && cdf[b] < q - 1e-12) {
+            b++;
+        }
+        return b;
+    };
+
+    // Woodruff: the confidence interval of the CDF at the estimate mapped
+    // back through the CDF
+    const size_t b = quantile(p);
+    double variance = 0;
+    for (size_t h = 0; h < strata.size(); h++) {
+        const double n = strata[h].latency.size();
+        if (n > 0) {
+            const double F = stratum_cdfs[h][b];
+            variance += weights[h] * weights[h] * F * (1 - F) / n
+                * fpc(strata[h]);
+        }
+    }
+    const double margin = Z_95 * std::sqrt(variance);
+    const auto value = [&](size_t bucket) {
+        return std::min(
+            std::max(LatencyHistogram::upper_bound(bucket), min), max);
+    };
+    estimate.value = value(b);
+    estimate.lower = value(quantile(std::max(p - margin, 0.0)));
+    estimate.upper = value(quantile(std::min(p + margin, 1.0)));
+    return estimate;
+}
+
+} // namespace ccd
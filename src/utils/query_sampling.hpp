@@ -0,0 +1,81 @@
+/// @brief Selecting and sampling benchmark queries, and estimating the
+/// latency of all queries from a stratified sample
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <utils/latency_histogram.hpp>
+
+namespace ccd {
+
+/// Match a whole string against a shell pattern with * (any characters,
+/// including /) and ? (one character).
+bool glob_match(const std::string& pattern, const std::string& text);
+
+/**
+ * @brief Picks a uniformly random subset of a sequence as it streams by.
+ *
+ * Knuth's selection sampling: the next item is taken with probability
+ * (items still to take) / (items left), so exactly sample_size of the
+ * population_size items are taken, without knowing them in advance.
+ */
+class SequentialSampler {
+public:
+    SequentialSampler(
+        uint64_t population_size, uint64_t sample_size, std::seed_seq& seed)
+        : num_left(population_size)
+        , num_to_take(std::min(sample_size, population_size))
+        , rng(seed)
+    {
+    }
+
+    /// @return Whether to take the next item.
+    bool next()
+    {
+        if (num_left == 0) {
+            return false;
+        }
+        const bool take = num_to_take > 0
+            && std::uniform_int_distribution<uint64_t>(0, num_left - 1)(rng)
+                < num_to_take;
+        num_left--;
+        num_to_take -= take;
+        return take;
+    }
+
+private:
+    uint64_t num_left, num_to_take;
+    std::mt19937_64 rng;
+};
+
+/// Split a sample of size n over strata in proportion to their sizes
+/// (largest remainder), with at least two per stratum so every stratum has
+/// a variance (the total may then exceed n).
+std::vector<uint64_t>
+allocate_sample(const std::vector<uint64_t>& stratum_sizes, uint64_t n);
+
+/// What a stratified sample measured in one stratum.
+struct SampledStratum {
+    uint64_t population_size = 0;
+    LatencyHistogram latency;       ///< of the sampled queries
+    double sum = 0, sum_squared = 0; ///< of the sampled latencies
+};
+
+/// An estimate with a 95% confidence interval.
+struct Estimate {
+    double value = NAN, lower = NAN, upper = NAN;
+};
+
+/// Estimate the mean latency of the population (normal approximation).
+Estimate estimate_mean(const std::vector<SampledStratum>& strata);
+
+/// Estimate the p-th quantile of the latency of the population with
+/// Woodruff's interval, at the resolution of the histogram buckets.
+Estimate
+estimate_percentile(const std::vector<SampledStratum>& strata, double p);
+
+} // namespace ccd
@@ -0,0 +1,331 @@
+#include "query_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <utils/read_rational_csv.hpp>
+
+namespace ccd {
+
+namespace {
+    /// Initial size of the CSV read buffer (grown to hold a block's lines)
+    const size_t CSV_BUFFER_SIZE = size_t(1) << 20;
+
+    bool has_extension(const std::string& path, const std::string& extension)
+    {
+        return path.size() >= extension.size()
+            && path.compare(
+                   path.size() - extension.size(), extension.size(), extension)
+            == 0;
+    }
+} // namespace
+
+QueryStream::QueryStream(
+    const std::string& file_path,
+    size_t max_block_size,
+    int max_threads,
+    QueryFilter query_filter)
+    : path(file_path)
+    , block_size(std::max(max_block_size, size_t(1)))
+    , num_threads(max_threads)
+    , filter(std::move(query_filter))
+{
+    if (has_extension(path, BINARY_QUERIES_EXTENSION)) {
+        binary_queries.reset(new BinaryQueries(path));
+        return;
+    }
+
+    file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        throw "unable to open file";
+    }
+    buffer.resize(CSV_BUFFER_SIZE);
+}
+
+QueryStream::~QueryStream()
+{
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+bool QueryStream::next(QueryBlock& block)
+{
+    block.queries.clear();
+    block.results.clear();
+    block.selected.clear();
+
+    if (binary_queries) {
+        const size_t n
+            = std::min(block_size, binary_queries->size() - next_query);
+        block.queries.resize(n);
+        block.results.resize((n + 63) / 64, 0);
+        if (filter) {
+            block.selected.resize((n + 63) / 64, 0);
+        }
+        for (size_t i = 0; i < n; i++, next_query++) {
+            const bool result = binary_queries->result(next_query);
+            block.results[i / 64] |= uint64_t(result) << (i % 64);
+            if (filter) {
+                if (!filter(next_query, result)) {
+                    continue;
+                }
+                block.selected[i / 64] |= uint64_t(1) << (i % 64);
+            }
+            block.queries[i] = binary_queries->query(next_query);
+        }
+        return n > 0;
+    }
+
+    while (block.size() < block_size) {
+        // Eight lines per query, less the rows of a query begun earlier
+        const size_t num_lines = read_csv_lines(
+            8 * (block_size - block.size()) - num_partial_rows);
+        if (num_lines == 0) {
+            if (num_partial_rows != 0) {
+                std::cerr << "Incomplete query at the end of file " << path
+                          << std::endl;
+                num_partial_rows = 0;
+            }
+            break;
+        }
+        const char* text = buffer.data() + buffer_begin;
+        if (filter) {
+            // Choose the queries by their ground truth first, and only
+            // convert the coordinates of those chosen.
+            is_vertex.resize(num_lines);
+            vertex_results.resize(num_lines);
+            is_line_selected.assign(num_lines, 0);
+            int num_rows = num_partial_rows;
+            bool is_selected = is_partial_query_selected;
+            size_t index = next_query;
+            for (size_t j = 0; j < num_lines; j++) {
+                bool result = false;
+                is_vertex[j] = parse_rational_csv_result(
+                    text + (j == 0 ? 0 : line_ends[j - 1] + 1),
+                    text + line_ends[j], path, line_number + 1 + long(j),
+                    result);
+                vertex_results[j] = result;
+                if (!is_vertex[j]) {
+                    continue;
+                }
+                if (num_rows == 0) {
+                    is_selected = filter(index, result);
+                }
+                is_line_selected[j] = is_selected;
+                if (++num_rows == 8) {
+                    num_rows = 0;
+                    index++;
+                }
+            }
+        }
+        parse_rational_csv_lines(
+            text, line_ends, line_number + 1, path, num_threads, vertices,
+            is_vertex, vertex_results, filter ? &is_line_selected : nullptr);
+        line_number += long(num_lines);
+        buffer_begin
+            = std::min(buffer_begin + line_ends.back() + 1, buffer_end);
+
+        for (size_t j = 0; j < num_lines; j++) {
+            if (!is_vertex[j]) {
+                continue;
+            }
+            // Every row of a query repeats its result.
+            if (num_partial_rows == 0) {
+                partial_query_result = vertex_results[j];
+                is_partial_query_selected = !filter || is_line_selected[j];
+            }
+            if (is_partial_query_selected) {
+                partial_query.row(num_partial_rows) << vertices[3 * j],
+                    vertices[3 * j + 1], vertices[3 * j + 2];
+            }
+            if (++num_partial_rows == 8) {
+                const size_t i = block.size();
+                next_query++;
+                block.queries.push_back(partial_query);
+                if (i % 64 == 0) {
+                    block.results.push_back(0);
+                    if (filter) {
+                        block.selected.push_back(0);
+                    }
+                }
+                block.results.back() |= uint64_t(partial_query_result)
+                    << (i % 64);
+                if (filter) {
+                    block.selected.back()
+                        |= uint64_t(is_partial_query_selected) << (i % 64);
+                }
+                num_partial_rows = 0;
+            }
+        }
+    }
+    return block.size() > 0;
+}
+
+QueryStreamPosition QueryStream::position() const
+{
+    QueryStreamPosition position;
+    position.query = next_query;
+    if (!binary_queries) {
+        position.offset = file_offset - (buffer_end - buffer_begin);
+        position.line_number = line_number;
+    }
+    return position;
+}
+
+void QueryStream::seek(const QueryStreamPosition& position)
+{
+    next_query = position.query;
+    if (binary_queries) {
+        return;
+    }
+    if (std::fseek(file, long(position.offset), SEEK_SET) != 0) {
+        throw "unable to seek in file";
+    }
+    buffer_begin = buffer_end = 0;
+    is_eof = false;
+    file_offset = position.offset;
+    line_number = position.line_number;
+    num_partial_rows = 0;
+    is_partial_query_selected = false;
+}
+
+size_t QueryStream::read_csv_lines(const size_t max_lines)
+{
+    line_ends.clear();
+    size_t scanned = buffer_begin; // the lines before are in line_ends
+    while (line_ends.size() < max_lines) {
+        const char* begin = buffer.data() + scanned;
+        const char* end = buffer.data() + buffer_end;
+        const char* line_end
+            = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+
+        if (line_end != nullptr) {
+            scanned = line_end - buffer.data() + 1;
+            line_ends.push_back(line_end - buffer.data() - buffer_begin);
+            continue;
+        }
+
+        if (is_eof) {
+            if (begin != end) {
+                // last line without a newline
+                scanned = buffer_end;
+                line_ends.push_back(buffer_end - buffer_begin);
+            }
+            break;
+        }
+
+        // Move the unparsed lines to the front and read more after them.
+        std::memmove(
+            buffer.data(), buffer.data() + buffer_begin,
+            buffer_end - buffer_begin);
+        scanned -= buffer_begin;
+        buffer_end -= buffer_begin;
+        buffer_begin = 0;
+        if (buffer_end == buffer.size()) {
+            buffer.resize(2 * buffer.size()); // the lines fill the buffer
+        }
+        const size_t num_read = std::fread(
+            buffer.data() + buffer_end, 1, buffer.size() - buffer_end, file);
+        buffer_end += num_read;
+        file_offset += num_read;
+        is_eof = num_read == 0;
+    }
+    return line_ends.size();
+}
+
+PrefetchedQueryStream::PrefetchedQueryStream(
+    const std::string& path,
+    size_t block_size,
+    size_t max_depth,
+    int num_threads,
+    const QueryStreamPosition& start,
+    QueryFilter filter)
+    : stream(path, block_size, num_threads, std::move(filter))
+    , depth(max_depth)
+{
+    stream.seek(start);
+    if (depth > 0) {
+        thread = std::thread(&PrefetchedQueryStream::read_ahead, this);
+    }
+}
+
+PrefetchedQueryStream::~PrefetchedQueryStream()
+{
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_stopped = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+}
+
+bool PrefetchedQueryStream::next(QueryBlock& block)
+{
+    if (depth == 0) {
+        return stream.next(block);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return !ready_blocks.empty() || is_done; });
+    if (ready_blocks.empty()) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return false;
+    }
+    free_blocks.push_back(std::move(block));
+    block = std::move(ready_blocks.front());
+    ready_blocks.pop_front();
+    lock.unlock();
+    condition.notify_all();
+    return true;
+}
+
+void PrefetchedQueryStream::read_ahead()
+{
+    while (true) {
+        QueryBlock block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] {
+                return is_stopped || ready_blocks.size() < depth;
+            });
+            if (is_stopped) {
+                return;
+            }
+            if (!free_blocks.empty()) {
+                block = std::move(free_blocks.back());
+                free_blocks.pop_back();
+            }
+        }
+
+        bool has_block = false;
+        std::exception_ptr read_error;
+        try {
+            has_block = stream.next(block);
+        } catch (...) {
+            read_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (has_block) {
+                ready_blocks.push_back(std::move(block));
+            } else {
+                is_done = true;
+                error = read_error;
+            }
+        }
+        condition.notify_all();
+        if (!has_block) {
+            return;
+        }
+    }
+}
+
+} // namespace ccd
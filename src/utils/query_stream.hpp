@@ -0,0 +1,167 @@
+/// @brief Pull-based reader of query files in fixed-size blocks
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <utils/binary_queries.hpp>
+
+namespace ccd {
+
+/// Consecutive queries of a file.
+struct QueryBlock {
+    std::vector<
+        Eigen::Matrix<double, 8, 3>,
+        Eigen::aligned_allocator<Eigen::Matrix<double, 8, 3>>>
+        queries;
+    std::vector<uint64_t> results; ///< Ground truth, one bit per query
+    /// With a QueryFilter, one bit per query of whether it was read
+    std::vector<uint64_t> selected;
+
+    size_t size() const { return queries.size(); }
+
+    bool result(size_t i) const { return (results[i / 64] >> (i % 64)) & 1; }
+
+    /// Whether queries[i] holds the query (rather than unread storage).
+    bool is_selected(size_t i) const
+    {
+        return selected.empty() || ((selected[i / 64] >> (i % 64)) & 1);
+    }
+};
+
+/// Called with the index in the file and the ground truth of every query in
+/// order, and returns whether to read it. The coordinates of rejected
+/// queries are not converted or copied.
+typedef std::function<bool(size_t index, bool result)> QueryFilter;
+
+/// Where a block of a query file starts, to resume reading there.
+struct QueryStreamPosition {
+    size_t query = 0;     ///< Index of the first query
+    uint64_t offset = 0;  ///< Byte offset of the first line (CSV files)
+    long line_number = 0; ///< Number of lines before it (CSV files)
+};
+
+/**
+ * @brief Reads the queries of a CSV or binary query file block by block.
+ *
+ * CSV files are read through a buffer that holds the lines of one block,
+ * and binary files through a memory map, so memory use is bounded by the
+ * block size rather than the file size, and queries can be processed
+ * before the whole file is read. The lines of a CSV block are parsed by up
+ * to num_threads threads. With a filter, the queries it rejects are only
+ * counted, so, e.g., a sample is read at a fraction of the cost. Throws a
+ * const char* if the file cannot be opened or is not a valid binary query
+ * file.
+ */
+class QueryStream {
+public:
+    explicit QueryStream(
+        const std::string& path,
+        size_t block_size = 4096,
+        int num_threads = 1,
+        QueryFilter filter = nullptr);
+    ~QueryStream();
+
+    QueryStream(const QueryStream&) = delete;
+    QueryStream& operator=(const QueryStream&) = delete;
+
+    /// Replace the contents of block with the next (up to block_size)
+    /// queries, reusing its storage.
+    /// @return False if there are no queries left.
+    bool next(QueryBlock& block);
+
+    /// Where the next block starts.
+    QueryStreamPosition position() const;
+
+    /// Continue at a position of the same file from position().
+    void seek(const QueryStreamPosition& position);
+
+private:
+    /// Read up to max_lines more lines of a CSV file into the buffer and
+    /// set line_ends to their ends (relative to buffer_begin).
+    /// @return The number of lines read.
+    size_t read_csv_lines(size_t max_lines);
+
+    std::string path;
+    size_t block_size;
+    int num_threads;
+    QueryFilter filter;
+    size_t next_query = 0;
+
+    // Binary files
+    std::unique_ptr<BinaryQueries> binary_queries;
+
+    // CSV files
+    std::FILE* file = nullptr;
+    std::vector<char> buffer;
+    size_t buffer_begin = 0, buffer_end = 0; ///< Unparsed bytes of buffer
+    bool is_eof = false;
+    uint64_t file_offset = 0; ///< of buffer_end
+    long line_number = 0;
+    std::vector<size_t> line_ends;
+    // Parsed lines
+    std::vector<double> vertices;
+    std::vector<char> is_vertex, vertex_results, is_line_selected;
+    // Rows of a query continued in the next lines
+    Eigen::Matrix<double, 8, 3> partial_query;
+    bool partial_query_result = false;
+    bool is_partial_query_selected = false;
+    int num_partial_rows = 0;
+};
+
+/**
+ * @brief QueryStream that reads ahead on a background thread.
+ *
+ * A background thread keeps up to depth blocks ready, so reading and
+ * parsing overlap with processing the current block. Block storage is
+ * recycled between the threads. With a depth of zero, blocks are read on
+ * the calling thread. Errors while reading are rethrown by next() after
+ * the blocks read before them.
+ */
+class PrefetchedQueryStream {
+public:
+    explicit PrefetchedQueryStream(
+        const std::string& path,
+        size_t block_size = 4096,
+        size_t depth = 2,
+        int num_threads = 1,
+        const QueryStreamPosition& start = QueryStreamPosition(),
+        QueryFilter filter = nullptr);
+    ~PrefetchedQueryStream();
+
+    PrefetchedQueryStream(const PrefetchedQueryStream&) = delete;
+    PrefetchedQueryStream& operator=(const PrefetchedQueryStream&) = delete;
+
+    /// @see QueryStream::next
+    bool next(QueryBlock& block);
+
+private:
+    void read_ahead();
+
+    QueryStream stream;
+    size_t depth;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<QueryBlock> ready_blocks;
+    std::vector<QueryBlock> free_blocks; ///< Storage to reuse
+    bool is_done = false;                ///< No more blocks will be read
+    bool is_stopped = false;             ///< Destructor is waiting
+    std::exception_ptr error;
+    std::thread thread;
+};
+
+} // namespace ccd
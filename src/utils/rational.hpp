@@ -2,117 +2,152 @@
 
 #include <gmp.h>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ccd {
 
-class Rational {
+/// @brief Thread-local storage for GMP rationals.
+///
+/// Every mpq_init/mpq_clear pair costs a malloc/free of the limbs. Rational
+/// takes its value from the free list of the calling thread and gives it back
+/// when destroyed, so temporaries reuse limbs already grown to the working
+/// size instead of allocating new ones per query.
+class RationalWorkspace {
 public:
-    mpq_t value;
-    void canonicalize() { mpq_canonicalize(value); }
-    int get_sign() const { return mpq_sgn(value); }
-    void print_numerator()
+    /// Values kept for reuse per thread; more are cleared.
+    static const size_t MAX_FREE_VALUES = 64;
+
+    /// Initialized values not in use by a Rational
+    std::vector<__mpq_struct> free_values;
+
+    /// Get the workspace of the calling thread, or nullptr once it was
+    /// destroyed at the exit of the thread.
+    static RationalWorkspace* local()
     {
-        mpz_t numerator;
-        mpz_init(numerator);
-        // std::cout<<"++++++++++++"<<std::endl;
-        mpq_get_num(numerator, value);
-        // std::cout<<"*************"<<std::endl;
-        mpz_out_str(NULL, 10, numerator);
-        // long v=mpz_get_si(numerator);
-        // std::cout<<v;
-        mpz_clear(numerator);
+        if (is_destroyed()) {
+            return nullptr;
+        }
+        thread_local RationalWorkspace workspace;
+        return &workspace;
     }
-    void print_denominator()
+
+    /// Initialize value, reusing a free value if there is one.
+    static void acquire(mpq_ptr value)
     {
-        mpz_t denominator;
-        mpz_init(denominator);
-        mpq_get_den(denominator, value);
+        RationalWorkspace* workspace = local();
+        if (workspace == nullptr || workspace->free_values.empty()) {
+            mpq_init(value);
+            return;
+        }
+        *value = workspace->free_values.back();
+        workspace->free_values.pop_back();
+        mpq_set_ui(value, 0, 1);
+    }
 
-        mpz_out_str(NULL, 10, denominator);
-        // long v=mpz_get_si(denominator);
-        // std::cout<<v;
-        mpz_clear(denominator);
+    /// Clear value, keeping its limbs for reuse if there is room.
+    static void release(mpq_ptr value)
+    {
+        RationalWorkspace* workspace = local();
+        if (workspace == nullptr
+            || workspace->free_values.size() >= MAX_FREE_VALUES) {
+            mpq_clear(value);
+            return;
+        }
+        workspace->free_values.push_back(*value);
     }
-    long long get_numerator()
+
+    ~RationalWorkspace()
     {
-        mpz_t numerator;
-        mpz_init(numerator);
+        is_destroyed() = true;
+        for (__mpq_struct& value : free_values) {
+            mpq_clear(&value);
+        }
+    }
 
-        mpq_get_num(numerator, value);
-        long long v = mpz_get_si(numerator);
+private:
+    RationalWorkspace() { free_values.reserve(MAX_FREE_VALUES); }
+    RationalWorkspace(const RationalWorkspace&) = delete;
+    RationalWorkspace& operator=(const RationalWorkspace&) = delete;
 
-        mpz_clear(numerator);
-        return v;
-    }
-    long long get_denominator()
+    /// Trivially destructible, so it stays valid after the workspace.
+    static bool& is_destroyed()
     {
-        mpz_t denominator;
-        mpz_init(denominator);
-        mpq_get_den(denominator, value);
-
-        long long v = mpz_get_si(denominator);
-        // std::string s(mpz_get_str(NULL, 10, denominator));
-        // long long v=std::stoll(s);
-        mpz_clear(denominator);
-        return v;
+        thread_local bool destroyed = false;
+        return destroyed;
     }
+};
+
+class Rational {
+public:
+    mpq_t value;
+    void canonicalize() { mpq_canonicalize(value); }
+    int get_sign() const { return mpq_sgn(value); }
+    void print_numerator() { mpz_out_str(NULL, 10, mpq_numref(value)); }
+    void print_denominator() { mpz_out_str(NULL, 10, mpq_denref(value)); }
+    long long get_numerator() { return mpz_get_si(mpq_numref(value)); }
+    long long get_denominator() { return mpz_get_si(mpq_denref(value)); }
     std::string get_denominator_str()
     {
-        mpz_t denominator;
-        mpz_init(denominator);
-        mpq_get_den(denominator, value);
-
-        std::string v(mpz_get_str(NULL, 10, denominator));
-
-        mpz_clear(denominator);
+        char* str = mpz_get_str(NULL, 10, mpq_denref(value));
+        std::string v(str);
+        free_str(str);
         return v;
     }
     std::string get_numerator_str()
     {
-        mpz_t numerator;
-        mpz_init(numerator);
-
-        mpq_get_num(numerator, value);
-        std::string v(mpz_get_str(NULL, 10, numerator));
-        ;
-
-        mpz_clear(numerator);
+        char* str = mpz_get_str(NULL, 10, mpq_numref(value));
+        std::string v(str);
+        free_str(str);
         return v;
     }
-    double get_double(const std::string& num, const std::string& denom)
+
+    /// Convert the base-10 fraction num/denom to double (truncated as in
+    /// mpq_get_d). Uses the thread-local workspace, so it does not allocate
+    /// once the workspace limbs are large enough.
+    static double get_double(const char* num, const char* denom)
     {
-        std::string tmp = num + "/" + denom;
-        mpq_set_str(value, tmp.c_str(), 10);
-        return mpq_get_d(value);
+        Rational q; // from the workspace
+        mpz_set_str(mpq_numref(q.value), num, 10);
+        mpz_set_str(mpq_denref(q.value), denom, 10);
+        return mpq_get_d(q.value);
     }
-
-    Rational()
+    static double get_double(const std::string& num, const std::string& denom)
     {
-        mpq_init(value);
-        mpq_set_d(value, 0);
+        return get_double(num.c_str(), denom.c_str());
     }
 
+    Rational() { RationalWorkspace::acquire(value); }
+
     Rational(double d)
     {
-        mpq_init(value);
+        RationalWorkspace::acquire(value);
         mpq_set_d(value, d);
         canonicalize();
     }
 
     Rational(const mpq_t& v_)
     {
-        mpq_init(value);
+        RationalWorkspace::acquire(value);
         mpq_set(value, v_);
         //            canonicalize();
     }
 
     Rational(const Rational& other)
     {
-        mpq_init(value);
+        RationalWorkspace::acquire(value);
         mpq_set(value, other.value);
     }
 
-    ~Rational() { mpq_clear(value); }
+    /// Steal the limbs of other, leaving it as zero.
+    Rational(Rational&& other)
+    {
+        RationalWorkspace::acquire(value);
+        mpq_swap(value, other.value);
+    }
+
+    ~Rational() { RationalWorkspace::release(value); }
 
     friend Rational operator-(const Rational& v)
     {
@@ -149,6 +184,84 @@ public:
         return r_out;
     }
 
+    // Temporaries are reused as the output to avoid initializing a new value.
+    friend Rational operator-(Rational&& v)
+    {
+        mpq_neg(v.value, v.value);
+        return std::move(v);
+    }
+    friend Rational operator+(Rational&& x, const Rational& y)
+    {
+        return std::move(x += y);
+    }
+    friend Rational operator+(const Rational& x, Rational&& y)
+    {
+        return std::move(y += x);
+    }
+    friend Rational operator+(Rational&& x, Rational&& y)
+    {
+        return std::move(x += y);
+    }
+    friend Rational operator-(Rational&& x, const Rational& y)
+    {
+        return std::move(x -= y);
+    }
+    friend Rational operator-(const Rational& x, Rational&& y)
+    {
+        mpq_sub(y.value, x.value, y.value);
+        return std::move(y);
+    }
+    friend Rational operator-(Rational&& x, Rational&& y)
+    {
+        return std::move(x -= y);
+    }
+    friend Rational operator*(Rational&& x, const Rational& y)
+    {
+        return std::move(x *= y);
+    }
+    friend Rational operator*(const Rational& x, Rational&& y)
+    {
+        return std::move(y *= x);
+    }
+    friend Rational operator*(Rational&& x, Rational&& y)
+    {
+        return std::move(x *= y);
+    }
+    friend Rational operator/(Rational&& x, const Rational& y)
+    {
+        return std::move(x /= y);
+    }
+    friend Rational operator/(const Rational& x, Rational&& y)
+    {
+        mpq_div(y.value, x.value, y.value);
+        return std::move(y);
+    }
+    friend Rational operator/(Rational&& x, Rational&& y)
+    {
+        return std::move(x /= y);
+    }
+
+    Rational& operator+=(const Rational& x)
+    {
+        mpq_add(value, value, x.value);
+        return *this;
+    }
+    Rational& operator-=(const Rational& x)
+    {
+        mpq_sub(value, value, x.value);
+        return *this;
+    }
+    Rational& operator*=(const Rational& x)
+    {
+        mpq_mul(value, value, x.value);
+        return *this;
+    }
+    Rational& operator/=(const Rational& x)
+    {
+        mpq_div(value, value, x.value);
+        return *this;
+    }
+
     Rational& operator=(const Rational& x)
     {
         if (this == &x)
@@ -157,6 +270,12 @@ public:
         return *this;
     }
 
+    Rational& operator=(Rational&& x)
+    {
+        mpq_swap(value, x.value);
+        return *this;
+    }
+
     Rational& operator=(const double x)
     {
         mpq_set_d(value, x);
@@ -204,5 +323,13 @@ public:
         os << mpq_get_d(r.value);
         return os;
     }
+
+private:
+    static void free_str(char* str)
+    {
+        void (*free_func)(void*, size_t);
+        mp_get_memory_functions(NULL, NULL, &free_func);
+        free_func(str, std::char_traits<char>::length(str) + 1);
+    }
 };
 } // namespace ccd
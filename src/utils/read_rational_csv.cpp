@@ -1,83 +1,367 @@
 #include "read_rational_csv.hpp"
 
-#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 
+#include <utils/mapped_file.hpp>
 #include <utils/rational.hpp>
 
 namespace ccd {
 
-Eigen::MatrixXd
-read_rational_csv(const std::string& inputFileName, std::vector<bool>& results)
+namespace {
+
+    /// Parse an optionally negative decimal integer of magnitude at most 2⁵³,
+    /// so it is exact as a double. Anything else is left to GMP.
+    bool parse_small_integer(const char* begin, const char* end, double& value)
+    {
+        const bool is_negative = begin != end && *begin == '-';
+        if (is_negative) {
+            begin++;
+        }
+        if (begin == end || end - begin > 16) {
+            return false;
+        }
+        uint64_t magnitude = 0;
+        for (const char* c = begin; c != end; c++) {
+            if (*c < '0' || *c > '9') {
+                return false;
+            }
+            magnitude = 10 * magnitude + uint64_t(*c - '0');
+        }
+        if (magnitude > (uint64_t(1) << 53)) {
+            return false;
+        }
+        // Through int64_t so that "-0" is +0 as in GMP
+        value = double(is_negative ? -int64_t(magnitude) : int64_t(magnitude));
+        return true;
+    }
+
+    /// n/d for integers |n| ≤ 2⁵³ and 0 < d ≤ 2⁵³ truncated toward zero as in
+    /// mpq_get_d.
+    double divide_toward_zero(const double n, const double d)
+    {
+        const double q = n / d;
+        uint64_t d_bits;
+        std::memcpy(&d_bits, &d, sizeof(d));
+        if ((d_bits & ((uint64_t(1) << 52) - 1)) == 0) {
+            return q; // exact for a power of two (the usual denominator)
+        }
+        // The remainder of a correctly rounded quotient is a double, so the
+        // fused multiply-add computes it exactly.
+        const double r = std::fma(-q, d, n);
+        if ((q > 0 && r < 0) || (q < 0 && r > 0)) {
+            return std::nextafter(q, 0.0); // q was rounded away from zero
+        }
+        return q;
+    }
+
+    /// Convert the base-10 fraction [num, num_end)/[denom, denom_end).
+    double rational_field_to_double(
+        const char* num,
+        const char* num_end,
+        const char* denom,
+        const char* denom_end)
+    {
+        double n, d;
+        if (parse_small_integer(num, num_end, n)
+            && parse_small_integer(denom, denom_end, d) && d > 0) {
+            return divide_toward_zero(n, d);
+        }
+        // Big integers; GMP needs null terminated strings.
+        thread_local std::string num_str, denom_str;
+        num_str.assign(num, num_end);
+        denom_str.assign(denom, denom_end);
+        return Rational::get_double(num_str.c_str(), denom_str.c_str());
+    }
+
+    /// Parse the lines in [begin, end) into all_v from row first_row on.
+    /// @param first_line  Line number of begin (for error messages).
+    /// @return Number of vertices parsed.
+    long parse_lines(
+        const char* const begin,
+        const char* const end,
+        const long first_line,
+        const std::string& inputFileName,
+        Eigen::MatrixXd& all_v,
+        const long first_row,
+        std::vector<bool>& results)
+    {
+        long num_vertices = 0;
+        long l = first_line;
+        for (const char* line = begin; line < end; l++) {
+            const char* line_end = static_cast<const char*>(
+                std::memchr(line, '\n', end - line));
+            if (line_end == nullptr) {
+                line_end = end;
+            }
+
+            double vertex[3];
+            bool result;
+            if (parse_rational_csv_line(
+                    line, line_end, inputFileName, l, vertex, result)) {
+                const long row = first_row + num_vertices;
+                all_v(row, 0) = vertex[0];
+                all_v(row, 1) = vertex[1];
+                all_v(row, 2) = vertex[2];
+                results.push_back(result);
+                num_vertices++;
+            }
+
+            line = line_end + 1;
+        }
+        return num_vertices;
+    }
+
+    /// Call f(k) for every k in [0, n), each on its own thread, and rethrow
+    /// the first exception in k order.
+    template <typename Function> void run_in_parallel(const int n, Function f)
+    {
+        std::vector<std::exception_ptr> errors(n);
+        auto run = [&](int k) {
+            try {
+                f(k);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int k = 1; k < n; k++) {
+            threads.emplace_back(run, k);
+        }
+        run(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+} // namespace
+
+bool parse_rational_csv_line(
+    const char* const line,
+    const char* const line_end,
+    const std::string& inputFileName,
+    const long l,
+    double vertex[3],
+    bool& result)
+{
+    if (line == line_end || *line == '#') {
+        return false;
+    }
+
+    // the first six are one vertex, the seventh is the result
+    const char* fields[8];
+    int c = 0;
+    fields[c++] = line;
+    for (const char* p = line; p != line_end && c < 8; p++) {
+        if (*p == ',') {
+            fields[c++] = p + 1;
+        }
+    }
+    if (c != 7) {
+        std::cout << "ERROR: expected 7 values in file " << inputFileName
+                  << " line " << l << std::endl;
+        return false;
+    }
+
+    // Each field ends at the comma before the next one.
+    for (int i = 0; i < 3; i++) {
+        vertex[i] = rational_field_to_double(
+            fields[2 * i], fields[2 * i + 1] - 1, fields[2 * i + 1],
+            fields[2 * i + 2] - 1);
+    }
+
+    const char* record = fields[6];
+    if (line_end - record == 1 && (*record == '0' || *record == '1')) {
+        result = *record == '1';
+    } else {
+        const std::string record_str(record, line_end);
+        std::cout << "ERROR:result position should be 1 or 0, but it is "
+                  << record_str << std::endl;
+        result = std::stoi(record_str);
+    }
+    return true;
+}
+
+bool parse_rational_csv_result(
+    const char* const line,
+    const char* const line_end,
+    const std::string& inputFileName,
+    const long l,
+    bool& result)
+{
+    if (line == line_end || *line == '#') {
+        return false;
+    }
+
+    const char* record = line;
+    int c = 1;
+    for (const char* p = line; p != line_end && c < 8; p++) {
+        if (*p == ',') {
+            record = p + 1;
+            c++;
+        }
+    }
+    if (c == 7 && line_end - record == 1
+        && (*record == '0' || *record == '1')) {
+        result = *record == '1';
+        return true;
+    }
+    // Let the full parser report the error.
+    double vertex[3];
+    return parse_rational_csv_line(
+        line, line_end, inputFileName, l, vertex, result);
+}
+
+void parse_rational_csv_lines(
+    const char* const text,
+    const std::vector<size_t>& line_ends,
+    const long first_line,
+    const std::string& inputFileName,
+    const int num_threads,
+    std::vector<double>& vertices,
+    std::vector<char>& is_vertex,
+    std::vector<char>& results,
+    const std::vector<char>* const lines_to_parse)
+{
+    const size_t num_lines = line_ends.size();
+    vertices.resize(3 * num_lines);
+    is_vertex.resize(num_lines);
+    results.resize(num_lines);
+
+    // Enough lines per thread to amortize starting it
+    const size_t min_chunk_lines = 4096;
+    const int num_chunks = int(std::max<size_t>(
+        1,
+        std::min<size_t>(
+            std::max(num_threads, 1), num_lines / min_chunk_lines)));
+    run_in_parallel(num_chunks, [&](int k) {
+        const size_t end = num_lines * (k + 1) / num_chunks;
+        for (size_t i = num_lines * k / num_chunks; i < end; i++) {
+            if (lines_to_parse != nullptr && !(*lines_to_parse)[i]) {
+                continue;
+            }
+            const char* line = text + (i == 0 ? 0 : line_ends[i - 1] + 1);
+            bool result = false;
+            is_vertex[i] = parse_rational_csv_line(
+                line, text + line_ends[i], inputFileName, first_line + long(i),
+                &vertices[3 * i], result);
+            results[i] = result;
+        }
+    });
+}
+
+Eigen::MatrixXd read_rational_csv(
+    const std::string& inputFileName,
+    std::vector<bool>& results,
+    const int num_threads)
 {
     // be careful, there are n lines which means there are n/8 queries, but has
     // n results, which means results are duplicated
     results.clear();
-    std::vector<std::array<double, 3>> vs;
-    vs.clear();
-    std::ifstream infile;
-    infile.open(inputFileName);
-    std::array<double, 3> v;
-    if (!infile.is_open()) {
+
+    std::unique_ptr<MappedFile> file;
+    try {
+        file.reset(new MappedFile(inputFileName));
+    } catch (const char*) {
         std::cout << "Path Wrong!!!!" << std::endl;
         std::cout << "path, " << inputFileName << std::endl;
         return Eigen::MatrixXd(1, 1);
     }
+    const char* const begin = file->data();
+    const char* const end = begin + file->size();
 
-    int l = 0;
-    while (infile) // there is input overload classfile
-    {
-        l++;
-        std::string s;
-        if (!getline(infile, s))
-            break;
-        if (s[0] != '#') {
-            std::istringstream ss(s);
-            std::array<std::string, 7> record; // the first six are one vetex,
-                                               // the seventh is the result
-            int c = 0;
-            while (ss) {
-                std::string line;
-                if (!getline(ss, line, ','))
-                    break;
-                try {
-                    record[c] = line;
-                    c++;
-                } catch (const std::invalid_argument e) {
-                    std::cout << "NaN found in file " << inputFileName
-                              << " line " << l << std::endl;
-                    e.what();
+    // Split at line boundaries into chunks of at least 1 MiB.
+    const size_t min_chunk_size = size_t(1) << 20;
+    const int num_chunks = int(std::max<size_t>(
+        1,
+        std::min<size_t>(
+            std::max(num_threads, 1), file->size() / min_chunk_size)));
+    std::vector<const char*> chunks(1, begin);
+    for (int k = 1; k < num_chunks; k++) {
+        const char* p = begin + file->size() / num_chunks * k;
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        chunks.push_back(std::max(chunks.back(), p == nullptr ? end : p + 1));
+    }
+    chunks.push_back(end);
+
+    // One vertex per line, so the lines before a chunk give its first row;
+    // comment lines leave gaps that are closed below.
+    std::vector<long> first_lines(num_chunks + 1, 0);
+    run_in_parallel(num_chunks, [&](int k) {
+        first_lines[k + 1] = std::count(chunks[k], chunks[k + 1], '\n');
+    });
+    first_lines[num_chunks] += begin != end && end[-1] != '\n';
+    for (int k = 0; k < num_chunks; k++) {
+        first_lines[k + 1] += first_lines[k];
+    }
+
+    Eigen::MatrixXd all_v(first_lines[num_chunks], 3);
+    std::vector<long> num_vertices(num_chunks);
+    std::vector<std::vector<bool>> chunk_results(num_chunks);
+    run_in_parallel(num_chunks, [&](int k) {
+        num_vertices[k] = parse_lines(
+            chunks[k], chunks[k + 1], first_lines[k] + 1, inputFileName, all_v,
+            first_lines[k], chunk_results[k]);
+    });
+
+    // Stitch the chunks together in order.
+    long num_rows = 0;
+    results.reserve(first_lines[num_chunks]);
+    for (int k = 0; k < num_chunks; k++) {
+        if (num_rows != first_lines[k]) {
+            for (int i = 0; i < 3; i++) {
+                for (long row = 0; row < num_vertices[k]; row++) {
+                    all_v(num_rows + row, i) = all_v(first_lines[k] + row, i);
                 }
             }
-            Rational rt;
-            double x = rt.get_double(record[0], record[1]),
-                   y = rt.get_double(record[2], record[3]),
-                   z = rt.get_double(record[4], record[5]);
-            v[0] = x;
-            v[1] = y;
-            v[2] = z;
-            vs.push_back(v);
-            if (record[6] != "1" && record[6] != "0") {
-                std::cout
-                    << "ERROR:result position should be 1 or 0, but it is "
-                    << record[6] << std::endl;
-            }
-            results.push_back(std::stoi(record[6]));
         }
-    }
-    Eigen::MatrixXd all_v(vs.size(), 3);
-    for (int i = 0; i < vs.size(); i++) {
-        all_v(i, 0) = vs[i][0];
-        all_v(i, 1) = vs[i][1];
-        all_v(i, 2) = vs[i][2];
-    }
-    if (!infile.eof()) {
-        std::cerr << "Could not read file " << inputFileName << "\n";
+        num_rows += num_vertices[k];
+        results.insert(
+            results.end(), chunk_results[k].begin(), chunk_results[k].end());
     }
 
+    all_v.conservativeResize(num_rows, 3);
     return all_v;
 }
 
+void write_rational_csv(
+    const std::string& outputFileName,
+    const Eigen::MatrixXd& V,
+    const std::vector<bool>& results,
+    const std::vector<std::string>& comments)
+{
+    std::ofstream file(outputFileName);
+    if (!file) {
+        throw "unable to open the output file";
+    }
+    for (const std::string& comment : comments) {
+        file << "# " << comment << "\n";
+    }
+    for (long row = 0; row < V.rows(); row++) {
+        for (int i = 0; i < 3; i++) {
+            Rational x(V(row, i));
+            file << x.get_numerator_str() << "," << x.get_denominator_str()
+                 << ",";
+        }
+        file << int(results[row]) << "\n";
+    }
+    file.close();
+    if (!file) {
+        throw "unable to write the output file";
+    }
+}
+
 } // namespace ccd
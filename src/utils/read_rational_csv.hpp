@@ -1,12 +1,70 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <Eigen/Core>
 
 namespace ccd {
 
-Eigen::MatrixXd
-read_rational_csv(const std::string& inputFileName, std::vector<bool>& results);
+/// Read the vertices and per-vertex ground truth of a rational query CSV.
+/// @param num_threads  Large files are split at line boundaries into chunks
+///                     of at least 1 MiB and parsed by up to this many threads.
+Eigen::MatrixXd read_rational_csv(
+    const std::string& inputFileName,
+    std::vector<bool>& results,
+    int num_threads = 1);
+
+/// Parse one line of a rational query CSV (without the newline).
+/// @param l  Line number for error messages.
+/// @return False for empty, comment, and malformed lines.
+bool parse_rational_csv_line(
+    const char* line,
+    const char* line_end,
+    const std::string& inputFileName,
+    long l,
+    double vertex[3],
+    bool& result);
+
+/// Read whether a line is a vertex and its ground truth like
+/// parse_rational_csv_line, without converting the coordinates.
+bool parse_rational_csv_result(
+    const char* line,
+    const char* line_end,
+    const std::string& inputFileName,
+    long l,
+    bool& result);
+
+/// Parse consecutive lines of a rational query CSV with up to num_threads
+/// threads, each taking at least a few thousand lines.
+/// @param text        Line i ends at text + line_ends[i], and the next one
+///                    starts after its newline.
+/// @param first_line  Line number of the first line (for error messages).
+/// @param vertices    Set to the three coordinates of every line.
+/// @param is_vertex   Set to whether each line is a vertex (see
+///                    parse_rational_csv_line).
+/// @param results     Set to the ground truth of every line.
+/// @param lines_to_parse  If given, only the lines with a nonzero entry are
+///                        parsed, and the entries of the others are kept.
+void parse_rational_csv_lines(
+    const char* text,
+    const std::vector<size_t>& line_ends,
+    long first_line,
+    const std::string& inputFileName,
+    int num_threads,
+    std::vector<double>& vertices,
+    std::vector<char>& is_vertex,
+    std::vector<char>& results,
+    const std::vector<char>* lines_to_parse = nullptr);
+
+/// Write vertices and per-vertex ground truth as a rational query CSV that
+/// read_rational_csv reads back exactly.
+/// @param comments  Lines to write first, each after a "# ".
+/// @throws const char* if the file cannot be written.
+void write_rational_csv(
+    const std::string& outputFileName,
+    const Eigen::MatrixXd& V,
+    const std::vector<bool>& results,
+    const std::vector<std::string>& comments = {});
 
 } // namespace ccd
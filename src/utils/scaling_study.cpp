@@ -0,0 +1,78 @@
+#include "scaling_study.hpp"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace ccd {
+
+std::vector<QueryRange>
+split_query_file(const std::string& path, size_t range_size)
+{
+    // Rejecting every query only reads the ground truth.
+    QueryStream stream(
+        path, range_size, /*num_threads=*/1,
+        [](size_t, bool) { return false; });
+    std::vector<QueryRange> ranges;
+    QueryBlock block;
+    QueryRange range = QueryRange();
+    range.start = stream.position();
+    while (stream.next(block)) {
+        for (size_t i = 0; i < block.size(); i++) {
+            range.num_queries[block.result(i)]++;
+        }
+        ranges.push_back(range);
+        range = QueryRange();
+        range.start = stream.position();
+    }
+    return ranges;
+}
+
+ScalingRecord make_scaling_record(
+    const std::string& method,
+    const int num_threads,
+    const ScalingRun& run,
+    const ScalingRecord* base)
+{
+    ScalingRecord record;
+    record.method = method;
+    record.num_threads = num_threads;
+    record.num_queries = run.num_queries;
+    record.wall_time = run.wall_time;
+    record.throughput = run.num_queries / run.wall_time;
+    if (base == nullptr) {
+        base = &record;
+    }
+    record.speedup = record.throughput / base->throughput;
+    record.efficiency = record.speedup * base->num_threads / num_threads;
+
+    double total_thread_time = 0, max_thread_time = 0;
+    for (double time : run.thread_times) {
+        total_thread_time += time;
+        max_thread_time = std::max(max_thread_time, time);
+    }
+    record.imbalance = total_thread_time > 0
+        ? max_thread_time * run.thread_times.size() / total_thread_time - 1
+        : 0;
+    record.average_time = 1e3 * run.total_time / run.num_queries;
+    return record;
+}
+
+void print_scaling_header()
+{
+    fmt::print(
+        "{:>7} {:>9} {:>12} {:>8} {:>10} {:>9} {:>11}\n", "threads",
+        "queries", "queries/s", "speedup", "efficiency", "imbalance",
+        "time/query");
+}
+
+void print_scaling_record(const ScalingRecord& record)
+{
+    fmt::print(
+        "{:>7d} {:>9d} {:>12.0f} {:>8.2f} {:>9.1f}% {:>8.1f}% {:>9.0f}ns\n",
+        record.num_threads, record.num_queries, record.throughput,
+        record.speedup, 100 * record.efficiency, 100 * record.imbalance,
+        record.average_time);
+}
+
+} // namespace ccd
@@ -0,0 +1,58 @@
+/// @brief Splitting query files into ranges for the thread-scaling study
+/// (--scaling) and summarizing its runs
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <utils/benchmark_report.hpp>
+#include <utils/query_stream.hpp>
+
+namespace ccd {
+
+/// Where a range of a query file starts and its number of negative and
+/// positive queries.
+struct QueryRange {
+    QueryStreamPosition start;
+    uint64_t num_queries[2];
+};
+
+/// Split a query file into consecutive ranges of range_size queries (the
+/// last one may be shorter), so threads can share the queries of a large
+/// file. Only the ground truth is read, not the coordinates. Throws a
+/// const char* if the file cannot be read.
+std::vector<QueryRange>
+split_query_file(const std::string& path, size_t range_size);
+
+/// What one run of a method with some number of threads measured.
+struct ScalingRun {
+    long num_queries = 0;
+    double wall_time = 0;  ///< s
+    double total_time = 0; ///< μs in the CCD calls of all threads
+    /// μs in the CCD calls of each thread
+    std::vector<double> thread_times;
+};
+
+/**
+ * @brief Summarize a run of the scaling study.
+ *
+ * @param base  The record of the same method with the fewest threads, which
+ *              speedup and efficiency are relative to, or nullptr if this is
+ *              that run.
+ */
+ScalingRecord make_scaling_record(
+    const std::string& method,
+    int num_threads,
+    const ScalingRun& run,
+    const ScalingRecord* base);
+
+/// Print the header of the table of a method's scaling records.
+void print_scaling_header();
+
+/// Print a record as a row of the table.
+void print_scaling_record(const ScalingRecord& record);
+
+} // namespace ccd
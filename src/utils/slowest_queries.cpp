@@ -0,0 +1,167 @@
+#include "slowest_queries.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <utils/read_rational_csv.hpp>
+
+namespace ccd {
+
+std::string format_query_options(const QueryOptions& options)
+{
+    return fmt::format(
+        "--preprocess {} -d {} --delta {} --mi {}",
+        options.preprocessing == NO_PREPROCESSING
+            ? "none"
+            : (options.preprocessing == TRANSLATE ? "translate" : "rescale"),
+        options.minimum_separation, options.tolerance, options.max_iter);
+}
+
+bool parse_query_options(const std::string& text, QueryOptions& options)
+{
+    std::istringstream stream(text);
+    for (std::string option, value; stream >> option;) {
+        if (!(stream >> value)) {
+            return false;
+        }
+        try {
+            if (option == "--preprocess") {
+                if (value == "none") {
+                    options.preprocessing = NO_PREPROCESSING;
+                } else if (value == "translate") {
+                    options.preprocessing = TRANSLATE;
+                } else if (value == "rescale") {
+                    options.preprocessing = TRANSLATE_AND_RESCALE;
+                } else {
+                    return false;
+                }
+            } else if (option == "-d") {
+                options.minimum_separation = std::stod(value);
+            } else if (option == "--delta") {
+                options.tolerance = std::stod(value);
+            } else if (option == "--mi") {
+                options.max_iter = std::stol(value);
+            } else {
+                return false;
+            }
+        } catch (const std::logic_error&) {
+            return false; // not a number
+        }
+    }
+    return true;
+}
+
+void write_slowest_queries(
+    const std::string& path,
+    const CCDMethod method,
+    const bool is_edge_edge,
+    const QueryOptions& options,
+    std::vector<SlowQuery> queries,
+    const size_t max_queries)
+{
+    std::sort(queries.begin(), queries.end(), SlowQuery::is_slower);
+    queries.resize(std::min(queries.size(), max_queries));
+
+    std::vector<std::string> comments = {
+        fmt::format("method: {}", method_names[method]),
+        fmt::format(
+            "query_type: {}", is_edge_edge ? "edge-edge" : "vertex-face"),
+        fmt::format("options: {}", format_query_options(options)),
+    };
+    Eigen::MatrixXd V(8 * queries.size(), 3);
+    std::vector<bool> results(V.rows());
+    for (size_t q = 0; q < queries.size(); q++) {
+        const SlowQuery& query = queries[q];
+        std::string counts;
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            if (!std::isnan(query.counts[e])) {
+                counts += fmt::format(
+                    ", {} {:.0f}", perf_event_names[e], query.counts[e]);
+            }
+        }
+        comments.push_back(fmt::format(
+            "query {}: {}:{}, {:.0f}ns, result {:d} (expected {:d}){}", q,
+            query.path, query.index, query.time, int(query.result),
+            int(query.expected_result), counts));
+        V.middleRows<8>(8 * q) = query.query;
+        std::fill_n(results.begin() + 8 * q, 8, query.expected_result);
+    }
+    write_rational_csv(path, V, results, comments);
+}
+
+SlowestQueries read_slowest_queries(const std::string& path)
+{
+    // The method, query type, and options are in the comments at the top.
+    std::string method_name, query_type, options;
+    bool has_options = false;
+    std::ifstream file(path);
+    if (!file) {
+        throw "unable to open file";
+    }
+    for (std::string line; std::getline(file, line) && line[0] == '#';) {
+        const size_t split = line.find(": ");
+        if (split == std::string::npos) {
+            continue;
+        }
+        const std::string key = line.substr(2, split - 2);
+        if (key == "method") {
+            method_name = line.substr(split + 2);
+        } else if (key == "query_type") {
+            query_type = line.substr(split + 2);
+        } else if (key == "options") {
+            options = line.substr(split + 2);
+            has_options = true;
+        }
+    }
+
+    SlowestQueries queries;
+    queries.has_options = has_options;
+    if (has_options && !parse_query_options(options, queries.options)) {
+        throw "unknown options";
+    }
+    const auto method_name_end = method_names + NUM_CCD_METHODS;
+    const auto method_name_it
+        = std::find(method_names, method_name_end, method_name);
+    if (method_name_it == method_name_end
+        || (query_type != "edge-edge" && query_type != "vertex-face")) {
+        throw "no method and query type";
+    }
+    queries.method = CCDMethod(method_name_it - method_names);
+    queries.is_edge_edge = query_type == "edge-edge";
+
+    queries.V = read_rational_csv(path, queries.expected_results);
+    if (queries.V.rows() % 8 != 0
+        || long(queries.expected_results.size()) != queries.V.rows()) {
+        throw "unable to read the queries";
+    }
+    return queries;
+}
+
+void print_replayed_queries(
+    std::vector<std::vector<double>> times,
+    const std::vector<bool>& results,
+    const std::vector<bool>& expected_results)
+{
+    fmt::print(
+        "{:>5} {:>12} {:>12} {:>7} {:>9}\n", "query", "median", "min",
+        "result", "expected");
+    for (size_t q = 0; q < times.size(); q++) {
+        std::vector<double>& query_times = times[q];
+        const double min_time
+            = *std::min_element(query_times.begin(), query_times.end());
+        std::nth_element(
+            query_times.begin(), query_times.begin() + query_times.size() / 2,
+            query_times.end());
+        fmt::print(
+            "{:>5d} {:>10.0f}ns {:>10.0f}ns {:>7d} {:>9d}\n", q,
+            query_times[query_times.size() / 2], min_time, int(results[q]),
+            int(expected_results[8 * q]));
+    }
+}
+
+} // namespace ccd
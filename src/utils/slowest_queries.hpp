@@ -0,0 +1,85 @@
+/// @brief Files of the slowest queries of a method (--dump-slowest) and their
+/// replay (--replay)
+///
+/// A file is a rational query CSV (see read_rational_csv.hpp) with the
+/// method, query type, and options of the run in its leading comments, and
+/// where each query is from, its time, result, and counters.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <ccd.hpp>
+#include <query_preprocessing.hpp>
+#include <utils/perf_counters.hpp>
+
+namespace ccd {
+
+/// Options of a run that change the result or time of a query.
+struct QueryOptions {
+    QueryPreprocessing preprocessing = NO_PREPROCESSING;
+    double minimum_separation = 0;
+    double tolerance = 1e-6; ///< Tight Inclusion δ
+    long max_iter = 1e6;     ///< Tight Inclusion maximum iterations
+};
+
+/// The options as on the command line of ccd_benchmark, with the values
+/// exact so parse_query_options reads them back.
+std::string format_query_options(const QueryOptions& options);
+
+/// Set options from a string of format_query_options.
+/// @return False if it is not one.
+bool parse_query_options(const std::string& text, QueryOptions& options);
+
+/// A query kept by --dump-slowest, with where it is from.
+struct SlowQuery {
+    double time; ///< ns
+    std::string path;
+    size_t index; ///< in the query file
+    Eigen::Matrix<double, 8, 3, Eigen::DontAlign> query;
+    bool result, expected_result;
+    double counts[NUM_PERF_EVENTS]; ///< NaN if not counted
+
+    /// Order of the heap of the slowest queries: the fastest on top.
+    static bool is_slower(const SlowQuery& a, const SlowQuery& b)
+    {
+        return a.time > b.time;
+    }
+};
+
+/// The contents of a file of slowest queries.
+struct SlowestQueries {
+    CCDMethod method;
+    bool is_edge_edge;
+    bool has_options; ///< false for files without them
+    QueryOptions options;
+    Eigen::MatrixXd V;                  ///< 8n×3 vertices
+    std::vector<bool> expected_results; ///< per vertex row
+};
+
+/// Write the slowest (at most max_queries) of some queries of a method,
+/// slowest first. Throws a const char* if the file cannot be written.
+void write_slowest_queries(
+    const std::string& path,
+    const CCDMethod method,
+    const bool is_edge_edge,
+    const QueryOptions& options,
+    std::vector<SlowQuery> queries,
+    size_t max_queries);
+
+/// Read a file of write_slowest_queries. Throws a const char* if it has no
+/// method or query type, unknown options, or invalid queries.
+SlowestQueries read_slowest_queries(const std::string& path);
+
+/// Print the median and minimum of the times (ns) of each replayed query
+/// with its result and ground truth.
+void print_replayed_queries(
+    std::vector<std::vector<double>> times,
+    const std::vector<bool>& results,
+    const std::vector<bool>& expected_results);
+
+} // namespace ccd
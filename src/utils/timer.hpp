@@ -8,7 +8,7 @@
 // High Resolution Timer.
 //
 // Resolution on Mac (clock tick)
-// Resolution on Linux (1 us not tested)
+// Resolution on Linux (1 ns, CLOCK_MONOTONIC)
 // Resolution on Windows (clock tick not tested)
 
 // clang-format off
@@ -20,7 +20,7 @@
 #elif __APPLE__ // Unix based system specific
 #include <mach/mach_time.h> // for mach_absolute_time
 #else
-#include <sys/time.h>
+#include <time.h>
 #endif
 #include <cstddef>
 
@@ -52,8 +52,8 @@ namespace ccd
       startCount = 0;
       endCount = 0;
 #else
-      startCount.tv_sec = startCount.tv_usec = 0;
-      endCount.tv_sec = endCount.tv_usec = 0;
+      startCount.tv_sec = startCount.tv_nsec = 0;
+      endCount.tv_sec = endCount.tv_nsec = 0;
 #endif
 
       stopped = 0;
@@ -94,7 +94,7 @@ namespace ccd
 #elif __APPLE__
       startCount = mach_absolute_time();
 #else
-      gettimeofday(&startCount, NULL);
+      clock_gettime(CLOCK_MONOTONIC, &startCount);
 #endif
 
     }
@@ -109,7 +109,7 @@ namespace ccd
 #elif __APPLE__
       endCount = mach_absolute_time();
 #else
-      gettimeofday(&endCount, NULL);
+      clock_gettime(CLOCK_MONOTONIC, &endCount);
 #endif
 
     }
@@ -148,17 +148,36 @@ namespace ccd
 
       return subtractTimes(endCount,startCount)/1e-6;
 #else
-      if(!stopped)
-        gettimeofday(&endCount, NULL);
-
-      startTimeInMicroSec =
-        (startCount.tv_sec * 1000000.0) + startCount.tv_usec;
-      endTimeInMicroSec = (endCount.tv_sec * 1000000.0) + endCount.tv_usec;
+      return this->getElapsedTimeInNanoSec() * 0.001;
 #endif
 
       return endTimeInMicroSec - startTimeInMicroSec;
     }
 
+    // get elapsed time in nano-second
+    double getElapsedTimeInNanoSec()
+    {
+#ifdef WIN32
+      if(!stopped)
+        QueryPerformanceCounter(&endCount);
+
+      return (endCount.QuadPart - startCount.QuadPart)
+        * (1000000000.0 / frequency.QuadPart);
+#elif __APPLE__
+      if (!stopped)
+        endCount = mach_absolute_time();
+
+      return subtractTimes(endCount,startCount)/1e-9;
+#else
+      if(!stopped)
+        clock_gettime(CLOCK_MONOTONIC, &endCount);
+
+      // Subtract the integers first; ns since boot can exceed 2^53.
+      return double(endCount.tv_sec - startCount.tv_sec) * 1000000000.0
+        + double(endCount.tv_nsec - startCount.tv_nsec);
+#endif
+    }
+
   private:
     // stop flag
     int    stopped;
@@ -171,8 +190,8 @@ namespace ccd
     uint64_t startCount;
     uint64_t endCount;
 #else
-    timeval startCount;
-    timeval endCount;
+    timespec startCount;
+    timespec endCount;
 #endif
   };
 }
@@ -1,6 +1,44 @@
 #include <catch2/catch.hpp>
 
 #include <ccd.hpp>
+#include <query_preprocessing.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#if CCD_WRAPPER_WITH_ERP
+#include <root_parity/expansion_root_parity.hpp>
+#endif
+#if CCD_WRAPPER_WITH_FXRP
+#include <root_parity/fixed_point_root_parity.hpp>
+#endif
+#if CCD_WRAPPER_WITH_RP_FILTER
+#include <root_parity/filtered_root_parity.hpp>
+#endif
+#if CCD_WRAPPER_WITH_RRP
+#include <ECCD.hpp>
+#endif
+
+#ifdef CCD_WRAPPER_WITH_RATIONAL_CSV
+#include <fmt/format.h>
+#include <ghc/fs_std.hpp> // filesystem
+#include <gmp.h>
+#include <utils/read_rational_csv.hpp>
+#endif
+
+#if CCD_WRAPPER_WITH_QUERY_RECORDING
+#include <query_recording.hpp>
+#endif
+
+#ifdef CCD_WRAPPER_WITH_BENCHMARK_UTILS
+#include <utils/binary_queries.hpp>
+#include <utils/parameter_sweep.hpp>
+#include <utils/scaling_study.hpp>
+#include <utils/slowest_queries.hpp>
+#endif
 
 static const double EPSILON = std::numeric_limits<float>::epsilon();
 
@@ -384,3 +422,608 @@ TEST_CASE("Teseo test case 2", "[!mayfail][ccd][edge-edge][teseo2]")
         CHECK(hit == expected_hit);
     }
 }
+
+#if CCD_WRAPPER_WITH_RP_FILTER && CCD_WRAPPER_WITH_ERP
+TEST_CASE("Root parity filter is certified", "[ccd][root-parity][filter]")
+{
+    using namespace ccd::root_parity;
+    // Grid coordinates produce many exactly degenerate queries.
+    const bool use_grid = GENERATE(false, true);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::uniform_int_distribution<int> grid(-2, 2);
+
+    int num_certified = 0;
+    for (int i = 0; i < 1000; i++) {
+        Eigen::Vector3d x[8];
+        for (int j = 0; j < 8; j++) {
+            for (int k = 0; k < 3; k++) {
+                x[j][k] = use_grid ? grid(gen) / 2.0 : uniform(gen);
+            }
+        }
+
+        bool filtered_hit;
+        if (vertexFaceCCD_filtered(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7],
+                filtered_hit)) {
+            num_certified++;
+            CHECK(
+                filtered_hit
+                == vertexFaceCCD_expansion(
+                    x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]));
+        }
+        if (edgeEdgeCCD_filtered(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7],
+                filtered_hit)) {
+            num_certified++;
+            CHECK(
+                filtered_hit
+                == edgeEdgeCCD_expansion(
+                    x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]));
+        }
+    }
+    CHECK(num_certified > 0);
+}
+#endif
+
+#if CCD_WRAPPER_WITH_RRP && (CCD_WRAPPER_WITH_ERP || CCD_WRAPPER_WITH_RP_FILTER)
+/// Check the in-tree root parity methods against the rational root parity
+/// they replace (without its filter) on one query.
+static void check_against_rational_root_parity(
+    const Eigen::Vector3d x[8], const bool is_edge_edge)
+{
+    using namespace ccd::root_parity;
+    const bool expected = is_edge_edge
+        ? eccd::edgeEdgeCCD(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7])
+        : eccd::vertexFaceCCD(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]);
+#if CCD_WRAPPER_WITH_ERP
+    CHECK(
+        (is_edge_edge ? edgeEdgeCCD_expansion : vertexFaceCCD_expansion)(
+            x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7])
+        == expected);
+#endif
+#if CCD_WRAPPER_WITH_RP_FILTER
+    bool filtered_hit;
+    if ((is_edge_edge ? edgeEdgeCCD_filtered : vertexFaceCCD_filtered)(
+            x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7], filtered_hit)) {
+        CHECK(filtered_hit == expected);
+    }
+#endif
+}
+
+TEST_CASE(
+    "Root parity methods match rational root parity",
+    "[ccd][root-parity][rational]")
+{
+    // Grid coordinates produce many exactly degenerate queries.
+    const bool use_grid = GENERATE(false, true);
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::uniform_int_distribution<int> grid(-2, 2);
+
+    for (int i = 0; i < 1000; i++) {
+        Eigen::Vector3d x[8];
+        for (int j = 0; j < 8; j++) {
+            for (int k = 0; k < 3; k++) {
+                x[j][k] = use_grid ? grid(gen) / 2.0 : uniform(gen);
+            }
+        }
+        check_against_rational_root_parity(x, false);
+        check_against_rational_root_parity(x, true);
+    }
+}
+
+#ifdef CCD_WRAPPER_SAMPLE_QUERIES_DIR
+TEST_CASE(
+    "Root parity methods match rational root parity on the sample queries",
+    "[ccd][root-parity][rational][sample]")
+{
+    const fs::path data_dir = CCD_WRAPPER_SAMPLE_QUERIES_DIR;
+    if (!fs::exists(data_dir)) {
+        WARN("no sample queries in " << data_dir.string());
+        return;
+    }
+    long num_queries = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(data_dir)) {
+        const fs::path& path = entry.path();
+        const std::string query_type = path.parent_path().filename().string();
+        if (path.extension() != ".csv"
+            || (query_type != "vertex-face" && query_type != "edge-edge")) {
+            continue;
+        }
+        std::vector<bool> results;
+        const Eigen::MatrixXd V
+            = ccd::read_rational_csv(path.string(), results);
+        for (long i = 0; i + 8 <= V.rows(); i += 8) {
+            CAPTURE(path.string(), i / 8);
+            Eigen::Vector3d x[8];
+            for (int j = 0; j < 8; j++) {
+                x[j] = V.row(i + j);
+            }
+            check_against_rational_root_parity(x, query_type == "edge-edge");
+            num_queries++;
+        }
+    }
+    CHECK(num_queries > 0);
+}
+#endif
+#endif
+
+#if CCD_WRAPPER_WITH_FXRP && CCD_WRAPPER_WITH_ERP
+TEST_CASE(
+    "Fixed-point root parity matches expansion root parity",
+    "[ccd][root-parity][fixed-point]")
+{
+    using namespace ccd::root_parity;
+    // Coarse grids produce many exactly degenerate queries; the finest grid
+    // uses the whole bit budget.
+    const int grid_bits = GENERATE(1, 8, FIXED_POINT_BITS);
+    const int64_t range = grid_bits == 1 ? 2 : int64_t(1) << grid_bits;
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int64_t> grid(-range, range);
+
+    for (int i = 0; i < 1000; i++) {
+        Eigen::Matrix<double, 8, 3> V;
+        for (int j = 0; j < V.size(); j++) {
+            V(j) = std::ldexp(double(grid(gen)), -grid_bits);
+        }
+        REQUIRE(fits_fixed_point_budget(V));
+        const Eigen::Vector3d x[8] = { V.row(0), V.row(1), V.row(2),
+                                       V.row(3), V.row(4), V.row(5),
+                                       V.row(6), V.row(7) };
+        CHECK(
+            vertexFaceCCD_fixed_point(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7])
+            == vertexFaceCCD_expansion(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]));
+        CHECK(
+            edgeEdgeCCD_fixed_point(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7])
+            == edgeEdgeCCD_expansion(
+                x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]));
+    }
+
+    // Out of budget, and quantized back into it
+    Eigen::Matrix<double, 8, 3> V = Eigen::Matrix<double, 8, 3>::Ones();
+    V(0) += std::ldexp(1.0, -FIXED_POINT_BITS);
+    CHECK(!fits_fixed_point_budget(V));
+    CHECK(fits_fixed_point_budget(quantize_to_fixed_point(V)));
+}
+#endif
+
+#if CCD_WRAPPER_WITH_ERP
+TEST_CASE("Query preprocessing preserves the answer", "[ccd][preprocessing]")
+{
+    using namespace ccd;
+    const QueryPreprocessing preprocessing
+        = GENERATE(TRANSLATE, TRANSLATE_AND_RESCALE);
+    const bool is_edge_edge = GENERATE(false, true);
+    // Small primitives far from the origin
+    const double offset = GENERATE(0.0, 100.0, -1e6);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> uniform(-1e-2, 1e-2);
+
+    for (int i = 0; i < 200; i++) {
+        Eigen::Matrix<double, 8, 3> V;
+        for (int j = 0; j < V.size(); j++) {
+            V(j) = offset + uniform(gen);
+        }
+        Eigen::Matrix<double, 8, 3> U = V;
+        const double scale
+            = preprocess_query(U, preprocessing, EXPANSION_ROOT_PARITY);
+        if (preprocessing == TRANSLATE) {
+            CHECK(U.array().abs().maxCoeff() <= V.array().abs().maxCoeff());
+            CHECK(scale == 1);
+        }
+
+        if (is_edge_edge) {
+            CHECK(
+                edgeEdgeCCD(
+                    U.row(0), U.row(1), U.row(2), U.row(3), U.row(4),
+                    U.row(5), U.row(6), U.row(7), EXPANSION_ROOT_PARITY)
+                == edgeEdgeCCD(
+                    V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
+                    V.row(5), V.row(6), V.row(7), EXPANSION_ROOT_PARITY));
+        } else {
+            CHECK(
+                vertexFaceCCD(
+                    U.row(0), U.row(1), U.row(2), U.row(3), U.row(4),
+                    U.row(5), U.row(6), U.row(7), EXPANSION_ROOT_PARITY)
+                == vertexFaceCCD(
+                    V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
+                    V.row(5), V.row(6), V.row(7), EXPANSION_ROOT_PARITY));
+        }
+    }
+}
+#endif
+
+TEST_CASE("Time of impact", "[ccd][toi]")
+{
+    using namespace ccd;
+    CCDMethod method = CCDMethod(GENERATE(range(0, int(NUM_CCD_METHODS))));
+    if (!is_method_enabled(method)) {
+        return;
+    }
+    bool has_toi;
+    switch (method) {
+    case FLOATING_POINT_ROOT_FINDER:
+    case MIN_SEPARATION_ROOT_FINDER:
+    case UNIVARIATE_INTERVAL_ROOT_FINDER:
+    case MULTIVARIATE_INTERVAL_ROOT_FINDER:
+    case TIGHT_INCLUSION:
+        has_toi = true;
+        break;
+    default:
+        has_toi = false;
+    }
+    const bool is_edge_edge = GENERATE(false, true);
+    // Moving down through the fixed primitive at t = 0.5, or missing it
+    const double x = GENERATE(0.0, 3.0);
+
+    Eigen::Matrix<double, 8, 3> V;
+    if (is_edge_edge) {
+        V << -1, 1, x, 1, 1, x, 0, 0, -1, 0, 0, 1, //
+            -1, -1, x, 1, -1, x, 0, 0, -1, 0, 0, 1;
+    } else {
+        V << x, 1, 0, -1, 0, 1, 1, 0, 1, 0, 0, -1, //
+            x, -1, 0, -1, 0, 1, 1, 0, 1, 0, 0, -1;
+    }
+
+    double toi = 0;
+    const bool hit = is_edge_edge
+        ? edgeEdgeCCD(
+            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4), V.row(5),
+            V.row(6), V.row(7), method, 1e-6, 1e6, { { -1, 0, 0 } }, &toi)
+        : vertexFaceCCD(
+            V.row(0), V.row(1), V.row(2), V.row(3), V.row(4), V.row(5),
+            V.row(6), V.row(7), method, 1e-6, 1e6, { { -1, 0, 0 } }, &toi);
+
+    CAPTURE(method_names[method], is_edge_edge, x, toi);
+    if (x == 0) {
+        CHECK(hit);
+    }
+    if (hit && has_toi) {
+        CHECK(toi == Approx(0.5).margin(1e-3));
+    } else {
+        CHECK(std::isnan(toi));
+    }
+}
+
+#ifdef CCD_WRAPPER_WITH_RATIONAL_CSV
+TEST_CASE("Rational CSV fields convert like mpq_get_d", "[rational-csv]")
+{
+    // Around the limit 2⁵³ of the fast path, non-dyadic and power of two
+    // denominators, signed zeros, and leading zeros
+    std::vector<std::string> numerators = { "0", "-0", "000", "-000", "1",
+                                            "-1", "0001", "-0003", "10" };
+    std::vector<std::string> denominators = { "1", "0001", "2", "3", "7",
+                                              "10", "1024", "000003" };
+    const int64_t p53 = int64_t(1) << 53;
+    for (int64_t k = -3; k <= 3; k++) {
+        numerators.push_back(std::to_string(p53 + k));
+        numerators.push_back(std::to_string(-(p53 + k)));
+        numerators.push_back("000" + std::to_string(p53 + k));
+        denominators.push_back(std::to_string(p53 + k));
+        denominators.push_back(std::to_string((p53 >> 1) + k));
+    }
+    std::mt19937_64 gen(5);
+    for (int i = 0; i < 40; i++) {
+        const int bits = int(gen() % 54);
+        const int64_t n = int64_t(gen() >> (64 - std::max(bits, 1)));
+        numerators.push_back(std::to_string(i % 2 ? -n : n));
+        denominators.push_back(std::to_string(
+            (int64_t(gen() >> (64 - std::max(bits, 2))) | 1)));
+    }
+
+    mpq_t expected;
+    mpq_init(expected);
+    for (const std::string& n : numerators) {
+        for (const std::string& d : denominators) {
+            const std::string line = fmt::format(
+                "{0},{1},{0},{1},{0},{1},1", n, d);
+            double vertex[3];
+            bool result;
+            REQUIRE(ccd::parse_rational_csv_line(
+                line.data(), line.data() + line.size(), "test", 1, vertex,
+                result));
+            mpz_set_str(mpq_numref(expected), n.c_str(), 10);
+            mpz_set_str(mpq_denref(expected), d.c_str(), 10);
+            const double x = mpq_get_d(expected);
+            CAPTURE(n, d, vertex[0], x);
+            // Bit-identical, including the sign of zero
+            CHECK(std::memcmp(&vertex[0], &x, sizeof(x)) == 0);
+            CHECK(vertex[1] == vertex[0]);
+            CHECK(vertex[2] == vertex[0]);
+            CHECK(result);
+        }
+    }
+    mpq_clear(expected);
+}
+#endif
+
+#if CCD_WRAPPER_WITH_QUERY_RECORDING && CCD_WRAPPER_WITH_ERP
+TEST_CASE("Query recording logs the calls of each thread", "[ccd][recording]")
+{
+    using namespace ccd;
+    const std::string path = "test_query_recording.ccdrec";
+    QueryRecordingOptions options;
+    options.path = path;
+    options.methods = 1u << EXPANSION_ROOT_PARITY;
+    options.buffer_size = 16; // flushed several times
+    REQUIRE(start_query_recording(options));
+
+    // A thread per query type; calls of other methods are left out.
+    std::vector<Eigen::Matrix<double, 8, 3, Eigen::DontAlign>> queries[2];
+    std::vector<bool> results[2];
+    const auto run = [&](const int is_edge_edge) {
+        std::mt19937 gen(is_edge_edge);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        for (int i = 0; i < 100; i++) {
+            Eigen::Matrix<double, 8, 3> V;
+            for (int j = 0; j < V.size(); j++) {
+                V(j) = uniform(gen);
+            }
+            const auto ccd = is_edge_edge ? edgeEdgeCCD : vertexFaceCCD;
+            ccd(V.row(0), V.row(1), V.row(2), V.row(3), V.row(4), V.row(5),
+                V.row(6), V.row(7), FIXED_POINT_ROOT_PARITY, 1e-6, 1e6,
+                { { -1, 0, 0 } }, nullptr);
+            results[is_edge_edge].push_back(
+                ccd(V.row(0), V.row(1), V.row(2), V.row(3), V.row(4),
+                    V.row(5), V.row(6), V.row(7), EXPANSION_ROOT_PARITY, 1e-6,
+                    1e6, { { -1, 0, 0 } }, nullptr));
+            queries[is_edge_edge].push_back(V);
+        }
+    };
+    std::thread thread(run, 1);
+    run(0);
+    thread.join();
+    stop_query_recording();
+
+    const std::vector<QueryRecord> records = read_query_recording(path);
+    std::remove(path.c_str());
+    CHECK(records.size() == 200);
+    size_t i[2] = { 0, 0 };
+    for (const QueryRecord& record : records) {
+        const int is_edge_edge = record.flags & RECORDED_EDGE_EDGE ? 1 : 0;
+        REQUIRE(i[is_edge_edge] < queries[is_edge_edge].size());
+        CHECK(record.method == EXPANSION_ROOT_PARITY);
+        CHECK(record.query() == queries[is_edge_edge][i[is_edge_edge]]);
+        CHECK(
+            bool(record.flags & RECORDED_RESULT)
+            == results[is_edge_edge][i[is_edge_edge]]);
+        CHECK(!(record.flags & (RECORDED_FALLBACK | RECORDED_MSCCD)));
+        i[is_edge_edge]++;
+    }
+}
+
+TEST_CASE(
+    "Query recording drops the calls running across a stop",
+    "[ccd][recording]")
+{
+    using namespace ccd;
+    const std::string paths[2] = { "test_query_recording_1.ccdrec",
+                                   "test_query_recording_2.ccdrec" };
+    QueryRecordingOptions options;
+    options.methods = 1u << EXPANSION_ROOT_PARITY;
+    options.buffer_size = 16;
+
+    // Threads keep calling with the recording they see as tolerance (which
+    // the method ignores but the records keep).
+    std::atomic<int> phase(1);
+    std::atomic<bool> is_done(false);
+    std::vector<std::atomic<long>> num_calls(3);
+    const auto run = [&](const int t) {
+        std::mt19937 gen(t);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        Eigen::Matrix<double, 8, 3> V;
+        while (!is_done) {
+            for (int j = 0; j < V.size(); j++) {
+                V(j) = uniform(gen);
+            }
+            vertexFaceCCD(
+                V.row(0), V.row(1), V.row(2), V.row(3), V.row(4), V.row(5),
+                V.row(6), V.row(7), EXPANSION_ROOT_PARITY, phase, 1e6);
+            num_calls[t]++;
+        }
+    };
+    // Until every thread started a call after this
+    const auto wait_for_calls = [&]() {
+        std::vector<long> before;
+        for (const std::atomic<long>& n : num_calls) {
+            before.push_back(n);
+        }
+        for (size_t t = 0; t < num_calls.size(); t++) {
+            while (num_calls[t] < before[t] + 2) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    options.path = paths[0];
+    REQUIRE(start_query_recording(options));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < int(num_calls.size()); t++) {
+        threads.emplace_back(run, t);
+    }
+    wait_for_calls();
+    stop_query_recording();
+    phase = 2;
+    wait_for_calls();
+    options.path = paths[1];
+    REQUIRE(start_query_recording(options));
+    wait_for_calls();
+    is_done = true;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    stop_query_recording();
+
+    for (int i = 0; i < 2; i++) {
+        const std::vector<QueryRecord> records
+            = read_query_recording(paths[i]);
+        std::remove(paths[i].c_str());
+        CHECK(!records.empty());
+        long num_other = 0;
+        for (const QueryRecord& record : records) {
+            num_other += record.tolerance != i + 1;
+        }
+        CHECK(num_other == 0);
+    }
+}
+#endif
+
+#ifdef CCD_WRAPPER_WITH_BENCHMARK_UTILS
+TEST_CASE("Query files split into ranges", "[benchmark][scaling]")
+{
+    using namespace ccd;
+    const size_t num_queries = 10000, range_size = 4096;
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    Eigen::MatrixXd V(8 * num_queries, 3);
+    for (int i = 0; i < V.size(); i++) {
+        V(i) = uniform(gen);
+    }
+    std::vector<bool> results(V.rows());
+    for (size_t i = 0; i < results.size(); i++) {
+        results[i] = (i / 8) % 3 == 0;
+    }
+
+    const bool is_binary = GENERATE(false, true);
+    const std::string path = is_binary ? "test_split.ccdq" : "test_split.csv";
+    if (is_binary) {
+        write_binary_queries(path, V, results, 0);
+    } else {
+        write_rational_csv(path, V, results, { "a comment" });
+    }
+    const std::vector<QueryRange> ranges = split_query_file(path, range_size);
+
+    CAPTURE(is_binary);
+    REQUIRE(ranges.size() == 3);
+    QueryBlock block;
+    for (size_t r = 0; r < ranges.size(); r++) {
+        const size_t first = r * range_size,
+                     end = std::min(first + range_size, num_queries);
+        CHECK(ranges[r].start.query == first);
+        uint64_t num_positives = 0;
+        for (size_t i = first; i < end; i++) {
+            num_positives += i % 3 == 0;
+        }
+        CHECK(ranges[r].num_queries[1] == num_positives);
+        CHECK(ranges[r].num_queries[0] == end - first - num_positives);
+
+        // A stream resumes at the start of the range.
+        QueryStream stream(path, range_size);
+        stream.seek(ranges[r].start);
+        REQUIRE(stream.next(block));
+        REQUIRE(block.size() == end - first);
+        CHECK(block.queries.front() == V.middleRows<8>(8 * first));
+        CHECK(block.queries.back() == V.middleRows<8>(8 * (end - 1)));
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Scaling records are relative to the fewest threads", "[scaling]")
+{
+    using namespace ccd;
+    ScalingRun run;
+    run.num_queries = 1000;
+    run.wall_time = 10;
+    run.total_time = 2000;
+    run.thread_times = { 2000 };
+    const ScalingRecord base = make_scaling_record("m", 1, run, nullptr);
+    CHECK(base.throughput == Approx(100));
+    CHECK(base.speedup == Approx(1));
+    CHECK(base.efficiency == Approx(1));
+    CHECK(base.imbalance == Approx(0));
+    CHECK(base.average_time == Approx(2000));
+
+    run.wall_time = 1000 / 300.0;
+    run.thread_times = { 500, 500, 500, 1500 };
+    const ScalingRecord record = make_scaling_record("m", 4, run, &base);
+    CHECK(record.speedup == Approx(3));
+    CHECK(record.efficiency == Approx(0.75));
+    CHECK(record.imbalance == Approx(1)); // the busiest thread had twice
+}
+
+TEST_CASE("Slowest query files keep their options", "[benchmark][slowest]")
+{
+    using namespace ccd;
+    QueryOptions options;
+    options.preprocessing = TRANSLATE_AND_RESCALE;
+    options.minimum_separation = 0.1 + 0.2; // not the shortest decimal
+    options.tolerance = 1.0 / 3;
+    options.max_iter = 12345;
+
+    std::vector<SlowQuery> queries(3);
+    for (size_t q = 0; q < queries.size(); q++) {
+        queries[q].time = double(q);
+        queries[q].path = "file.csv";
+        queries[q].index = q;
+        queries[q].query.setConstant(q + 0.5);
+        queries[q].result = queries[q].expected_result = q == 1;
+        std::fill_n(queries[q].counts, NUM_PERF_EVENTS, NAN);
+    }
+    queries[0].counts[0] = 42;
+    const std::string path = "test_slowest.csv";
+    write_slowest_queries(
+        path, EXPANSION_ROOT_PARITY, /*is_edge_edge=*/true, options, queries,
+        /*max_queries=*/2);
+
+    const SlowestQueries file = read_slowest_queries(path);
+    std::remove(path.c_str());
+    CHECK(file.method == EXPANSION_ROOT_PARITY);
+    CHECK(file.is_edge_edge);
+    REQUIRE(file.has_options);
+    CHECK(file.options.preprocessing == options.preprocessing);
+    CHECK(file.options.minimum_separation == options.minimum_separation);
+    CHECK(file.options.tolerance == options.tolerance);
+    CHECK(file.options.max_iter == options.max_iter);
+    CHECK(format_query_options(file.options) == format_query_options(options));
+    // The two slowest, slowest first
+    REQUIRE(file.V.rows() == 16);
+    CHECK(file.V.topRows<8>() == queries[2].query);
+    CHECK(file.V.bottomRows<8>() == queries[1].query);
+    CHECK(!file.expected_results[0]);
+    CHECK(file.expected_results[8]);
+
+    QueryOptions parsed;
+    CHECK(!parse_query_options("--delta", parsed));
+    CHECK(!parse_query_options("--delta x", parsed));
+    CHECK(!parse_query_options("--preprocess all", parsed));
+    CHECK(!parse_query_options("--unknown 1", parsed));
+    CHECK(parse_query_options("", parsed));
+}
+
+TEST_CASE("Sweep points on the Pareto frontier", "[benchmark][sweep]")
+{
+    using namespace ccd;
+    const std::vector<std::pair<double, long>> settings
+        = sweep_settings({ 1e-4, 1e-6, 1e-2 }, { 1000, 1000000 });
+    REQUIRE(settings.size() == 6);
+    CHECK(settings[0] == std::make_pair(1e-6, 1000000L));
+
+    // NaN where either does not compute a time of impact
+    SweepPoint point;
+    measure_toi_error({ 0.5, NAN, 0.25, 0.1 }, { 0.4, 0.5, NAN, 0.1 }, point);
+    CHECK(point.mean_toi_error == Approx(0.05));
+    CHECK(point.max_toi_error == Approx(0.1));
+
+    SweepPoint a;
+    a.average_time = 100;
+    a.max_toi_error = 1e-6;
+    SweepPoint b = a;
+    CHECK(!dominates(a, b)); // equal
+    b.max_toi_error = 1e-3;
+    CHECK(dominates(a, b));
+    CHECK(!dominates(b, a));
+    b.average_time = 50; // faster but less accurate
+    CHECK(!dominates(a, b));
+    CHECK(!dominates(b, a));
+    SweepPoint c = a;
+    c.num_false_positives = 1;
+    SweepPoint d = b;
+    d.average_time = 200;
+    CHECK(pareto_frontier({ a, b, c, d })
+          == std::vector<bool> { true, true, false, false });
+}
+#endif
@@ -69,6 +69,11 @@ vertices=[]
 truth=True
 for line in r.readlines():
     # print(line)
+    if line.startswith("#"):
+        # comments (e.g., of ccd_benchmark --dump-slowest) are not vertices
+        if line.startswith("# query_type:"):
+            is_edge_edge=line.split(":")[1].strip()=="edge-edge"
+        continue
     if line_nbr>=query_id*8 and line_nbr<=query_id*8+7:
         # deal with this line, get 3 floating-point number and a boolean value 
         strings=line.split("\n")[0]